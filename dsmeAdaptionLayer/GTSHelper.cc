@@ -66,6 +66,7 @@ void GTSHelper::initialize(GTSScheduling* scheduling) {
     this->gtsScheduling = scheduling;
 
     this->dsmeAdaptionLayer.getDSME().setStartOfCFPDelegate(DELEGATE(&GTSHelper::handleStartOfCFP, *this)); /* BAD cross-layer hack */
+    this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.setAllocationChangedDelegate(DELEGATE(&GTSHelper::handleAllocationChanged, *this));
 
     this->dsmeAdaptionLayer.getMLME_SAP().getDSME_GTS().indication(DELEGATE(&GTSHelper::handleDSME_GTS_indication, *this));
     this->dsmeAdaptionLayer.getMLME_SAP().getDSME_GTS().confirm(DELEGATE(&GTSHelper::handleDSME_GTS_confirm, *this));
@@ -90,25 +91,83 @@ void GTSHelper::indicateReceivedMessage(uint16_t address) {
     return this->gtsScheduling->registerReceivedMessage(address);
 }
 
+void GTSHelper::indicateDeadlineMiss(uint16_t address) {
+    this->gtsScheduling->registerDeadlineMiss(address);
+}
+
 void GTSHelper::handleStartOfCFP() {
     if(this->dsmeAdaptionLayer.getDSME().getCurrentSuperframe() == 0) {
         this->gtsScheduling->multisuperframeEvent();
     }
 
+    if(this->dsmeAdaptionLayer.getDSME().getCentralScheduler().isEnabled()) {
+        /* '-> no handshakes, the slot targets are reported to the PAN coordinator instead */
+        if(this->dsmeAdaptionLayer.getDSME().getCurrentSuperframe() == 0) {
+            CentralScheduler& centralScheduler = this->dsmeAdaptionLayer.getDSME().getCentralScheduler();
+            centralScheduler.beginDemands();
+            this->gtsScheduling->getSlotTargets(DELEGATE(&GTSHelper::reportSlotTarget, *this));
+            centralScheduler.endDemands();
+        }
+        return;
+    }
+
     /* Check allocation at random superframe in multi-superframe */
     uint8_t num_superframes = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe();
     uint8_t random_frame = this->dsmeAdaptionLayer.getDSME().getPlatform().getRandom() % num_superframes;
     //if(this->dsmeAdaptionLayer.getDSME().getCurrentSuperframe() == random_frame) {
-    performSchedulingAction(this->gtsScheduling->getNextSchedulingAction());
+    GTSSchedulingDecision decision = getUrgentSchedulingAction();
+    if(decision.numSlot == 0) {
+        decision = this->gtsScheduling->getNextSchedulingAction();
+    }
+    performSchedulingAction(decision);
     //}
     return;
 }
 
-void GTSHelper::checkAllocationForPacket(uint16_t address) {
-    performSchedulingAction(this->gtsScheduling->getNextSchedulingAction(address));
+void GTSHelper::handleAllocationChanged(uint16_t address, Direction direction) {
+    if(this->gtsScheduling != nullptr) {
+        this->gtsScheduling->registerAllocationChange(address, direction);
+    }
+    return;
+}
+
+void GTSHelper::reportSlotTarget(uint16_t address, int16_t slotTarget) {
+    this->dsmeAdaptionLayer.getDSME().getCentralScheduler().setDemand(address, (slotTarget > 0xFF) ? 0xFF : ((slotTarget > 0) ? slotTarget : 0));
+}
+
+void GTSHelper::checkAllocationForPacket(uint16_t address, Priority priority) {
+    if(this->dsmeAdaptionLayer.getDSME().getCentralScheduler().isEnabled()) {
+        return;
+    }
+    GTSSchedulingDecision decision = this->gtsScheduling->getNextSchedulingAction(address);
+    if(this->dsmeAdaptionLayer.getMAC_PIB().macPriorityChannelAccess) {
+        decision.priority = priority;
+    }
+    performSchedulingAction(decision);
     return;
 }
 
+GTSSchedulingDecision GTSHelper::getUrgentSchedulingAction() {
+    if(!this->dsmeAdaptionLayer.getMAC_PIB().macPriorityChannelAccess) {
+        return NO_SCHEDULING_ACTION;
+    }
+
+    NeighborQueue<MAX_NEIGHBORS>& neighborQueue = this->dsmeAdaptionLayer.getDSME().getMessageDispatcher().getNeighborQueue();
+    for(NeighborQueue<MAX_NEIGHBORS>::iterator it = neighborQueue.begin(); it != neighborQueue.end(); ++it) {
+        if(neighborQueue.front(it, TrafficClass::CRITICAL) == nullptr) {
+            continue;
+        }
+
+        GTSSchedulingDecision decision = this->gtsScheduling->getNextSchedulingAction(it->address.getShortAddress());
+        if(decision.numSlot > 0 && decision.managementType == ManagementType::ALLOCATION) {
+            /* '-> links with critical packets are served before all others */
+            decision.priority = Priority::HIGH;
+            return decision;
+        }
+    }
+    return NO_SCHEDULING_ACTION;
+}
+
 void GTSHelper::performSchedulingAction(GTSSchedulingDecision decision) {
     if(decision.numSlot == 0) {
         LOG_DEBUG("NO SCHEDULING ACTION");
@@ -120,7 +179,7 @@ void GTSHelper::performSchedulingAction(GTSSchedulingDecision decision) {
     if(decision.managementType == ManagementType::ALLOCATION) {
         checkAndAllocateGTS(decision);
     } else if(decision.managementType == ManagementType::DEALLOCATION) {
-        checkAndDeallocateSingeleGTS(decision.deviceAddress);
+        checkAndDeallocateGTS(decision.deviceAddress, decision.numSlot);
     } else {
         DSME_ASSERT(false);
     }
@@ -142,7 +201,8 @@ void GTSHelper::checkAndAllocateGTS(GTSSchedulingDecision decision) {
 
     uint8_t numChannels = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumChannels();
 
-    GTS preferredGTS = getNextFreeGTS(decision.preferredSuperframeId, decision.preferredSlotId);
+    GTS preferredGTS = (decision.placementHint == GTSPlacementHint::FOLLOWING) ? getFollowingFreeGTS(decision.preferredSuperframeId, decision.preferredSlotId)
+                                                                                : getNextFreeGTS(decision.preferredSuperframeId, decision.preferredSlotId);
 
     if(preferredGTS == GTS::UNDEFINED) {
         LOG_ERROR("No free GTS found! (trying with 0x" << HEXOUT << decision.deviceAddress << DECOUT << ")");
@@ -154,7 +214,7 @@ void GTSHelper::checkAndAllocateGTS(GTSSchedulingDecision decision) {
     params.deviceAddress = decision.deviceAddress;
     params.managementType = ManagementType::ALLOCATION;
     params.direction = decision.direction;
-    params.prioritizedChannelAccess = Priority::LOW;
+    params.prioritizedChannelAccess = decision.priority;
     params.numSlot = decision.numSlot;
     params.preferredSuperframeId = preferredGTS.superframeID;
     params.preferredSlotId = preferredGTS.slotID;
@@ -179,32 +239,50 @@ void GTSHelper::checkAndAllocateGTS(GTSSchedulingDecision decision) {
     return;
 }
 
-void GTSHelper::checkAndDeallocateSingeleGTS(uint16_t address) {
+void GTSHelper::checkAndDeallocateGTS(uint16_t address, uint8_t numSlots) {
     DSMEAllocationCounterTable& act = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT;
-    int16_t highestIdleCounter = -1;
-    DSMEAllocationCounterTable::iterator toDeallocate = act.end();
-    for(auto it = act.begin(); it != act.end(); ++it) {
-        if(it->getDirection() == Direction::TX && it->getAddress() == address) {
-            if(it->getState() == ACTState::VALID && it->getIdleCounter() > highestIdleCounter) {
-                highestIdleCounter = it->getIdleCounter();
-                toDeallocate = it;
+    uint8_t numChannels = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumChannels();
+
+    DSMESABSpecification dsmeSABSpecification;
+    DSMEAllocationCounterTable::iterator first = act.end();
+
+    /* Select the slots with the highest idle counters, all of them have to be in the superframe of the first one,
+     * since per convention a sub block holds exactly one superframe */
+    for(uint8_t i = 0; i < numSlots; i++) {
+        int16_t highestIdleCounter = -1;
+        DSMEAllocationCounterTable::iterator toDeallocate = act.end();
+        for(auto it = act.begin(); it != act.end(); ++it) {
+            if(it->getDirection() == Direction::TX && it->getAddress() == address) {
+                if(first != act.end() &&
+                   (it->getSuperframeID() != first->getSuperframeID() || dsmeSABSpecification.getSubBlock().get(it->getGTSlotID() * numChannels + it->getChannel()))) {
+                    continue;
+                }
+                if(it->getState() == ACTState::VALID && it->getIdleCounter() > highestIdleCounter) {
+                    highestIdleCounter = it->getIdleCounter();
+                    toDeallocate = it;
+                }
             }
         }
-    }
 
-    if(toDeallocate != act.end()) {
+        if(toDeallocate == act.end()) {
+            break;
+        }
+
         LOG_INFO("DEALLOCATING slot " << toDeallocate->getSuperframeID() << "/" << toDeallocate->getGTSlotID() << " with 0x" << HEXOUT
                                       << toDeallocate->getAddress() << DECOUT);
 
-        DSMESABSpecification dsmeSABSpecification;
-        uint8_t subBlockLengthBytes = this->dsmeAdaptionLayer.getMAC_PIB().helper.getSubBlockLengthBytes(toDeallocate->getSuperframeID());
-        dsmeSABSpecification.setSubBlockLengthBytes(subBlockLengthBytes);
-        dsmeSABSpecification.setSubBlockIndex(toDeallocate->getSuperframeID());
-        dsmeSABSpecification.getSubBlock().fill(false);
-        dsmeSABSpecification.getSubBlock().set(
-            toDeallocate->getGTSlotID() * this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumChannels() + toDeallocate->getChannel(), true);
+        if(first == act.end()) {
+            first = toDeallocate;
+            uint8_t subBlockLengthBytes = this->dsmeAdaptionLayer.getMAC_PIB().helper.getSubBlockLengthBytes(toDeallocate->getSuperframeID());
+            dsmeSABSpecification.setSubBlockLengthBytes(subBlockLengthBytes);
+            dsmeSABSpecification.setSubBlockIndex(toDeallocate->getSuperframeID());
+            dsmeSABSpecification.getSubBlock().fill(false);
+        }
+        dsmeSABSpecification.getSubBlock().set(toDeallocate->getGTSlotID() * numChannels + toDeallocate->getChannel(), true);
+    }
 
-        sendDeallocationRequest(toDeallocate->getAddress(), toDeallocate->getDirection(), dsmeSABSpecification);
+    if(first != act.end()) {
+        sendDeallocationRequest(first->getAddress(), first->getDirection(), dsmeSABSpecification);
     }
 }
 
@@ -367,9 +445,7 @@ void GTSHelper::handleDSME_GTS_confirm(mlme_sap::DSME_GTS_confirm_parameters& pa
 
 GTS GTSHelper::getNextFreeGTS(uint16_t initialSuperframeID, uint8_t initialSlotID, const DSMESABSpecification* sabSpec) {
     DSMEAllocationCounterTable& macDSMEACT = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT;
-    DSMESlotAllocationBitmap& macDSMESAB = this->dsmeAdaptionLayer.getMAC_PIB().macDSMESAB;
 
-    uint8_t numChannels = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumChannels();
     uint8_t numSuperFramesPerMultiSuperframe = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe();
     uint16_t slotsToCheck = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumGTSlots(0) +
                             (this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe() - 1) *
@@ -377,13 +453,8 @@ GTS GTSHelper::getNextFreeGTS(uint16_t initialSuperframeID, uint8_t initialSlotI
 
     GTS gts(0, 0, 0);
 
-    BitVector<MAX_CHANNELS> occupied;
-    BitVector<MAX_CHANNELS> remoteOccupied; // only used if sabSpec != nullptr
-    occupied.setLength(numChannels);
-
     if(sabSpec != nullptr) {
         DSME_ASSERT(sabSpec->getSubBlockIndex() == initialSuperframeID);
-        remoteOccupied.setLength(numChannels);
     }
 
     for(gts.superframeID = initialSuperframeID; slotsToCheck > 0; gts.superframeID = (gts.superframeID + 1) % numSuperFramesPerMultiSuperframe) {
@@ -395,26 +466,9 @@ GTS GTSHelper::getNextFreeGTS(uint16_t initialSuperframeID, uint8_t initialSlotI
         uint8_t numGTSlots = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumGTSlots(gts.superframeID);
         LOG_INFO("Checking " << numGTSlots << " in superframe " << gts.superframeID);
         for(gts.slotID = initialSlotID % numGTSlots; slotsToCheck > 0; gts.slotID = (gts.slotID + 1) % numGTSlots) {
-            if(!macDSMEACT.isAllocated(gts.superframeID, gts.slotID)) {
-                uint8_t startChannel = this->dsmeAdaptionLayer.getDSME().getPlatform().getRandom() % numChannels;
-                macDSMESAB.getOccupiedChannels(occupied, gts.superframeID, gts.slotID);
-                if(sabSpec != nullptr) {
-                    remoteOccupied.copyFrom(sabSpec->getSubBlock(), gts.slotID * numChannels);
-                    occupied.setOperationJoin(remoteOccupied);
-                }
-
-                gts.channel = startChannel;
-                for(uint8_t i = 0; i < numChannels; i++) {
-                    if(!occupied.get(gts.channel)) {
-                        /* found one */
-                        return gts;
-                    }
-
-                    gts.channel++;
-                    if(gts.channel == numChannels) {
-                        gts.channel = 0;
-                    }
-                }
+            if(!macDSMEACT.isAllocated(gts.superframeID, gts.slotID) && selectFreeChannel(gts, sabSpec)) {
+                /* found one */
+                return gts;
             }
             slotsToCheck--;
             if((gts.slotID+1)%numGTSlots == initialSlotID) {
@@ -426,15 +480,74 @@ GTS GTSHelper::getNextFreeGTS(uint16_t initialSuperframeID, uint8_t initialSlotI
     return GTS::UNDEFINED;
 }
 
-GTSStatus::GTS_Status GTSHelper::verifyDeallocation(DSMESABSpecification& requestSABSpec, uint16_t& deviceAddress, Direction& direction) {
-    GTSStatus::GTS_Status result;
+GTS GTSHelper::getFollowingFreeGTS(uint16_t initialSuperframeID, uint8_t initialSlotID) {
+    DSMEAllocationCounterTable& macDSMEACT = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT;
+
+    uint8_t numSuperFramesPerMultiSuperframe = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe();
+    uint16_t slotsToCheck = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumGTSlots(0) +
+                            (this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe() - 1) *
+                                this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumGTSlots(1);
 
+    GTS gts(initialSuperframeID % numSuperFramesPerMultiSuperframe, initialSlotID, 0);
+    if(gts.slotID >= this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumGTSlots(gts.superframeID)) {
+        gts.superframeID = (gts.superframeID + 1) % numSuperFramesPerMultiSuperframe;
+        gts.slotID = 0;
+    }
+
+    for(; slotsToCheck > 0; slotsToCheck--) {
+        if(!macDSMEACT.isAllocated(gts.superframeID, gts.slotID) && selectFreeChannel(gts, nullptr)) {
+            return gts;
+        }
+
+        gts.slotID++;
+        if(gts.slotID == this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumGTSlots(gts.superframeID)) {
+            gts.superframeID = (gts.superframeID + 1) % numSuperFramesPerMultiSuperframe;
+            gts.slotID = 0;
+        }
+    }
+
+    return GTS::UNDEFINED;
+}
+
+/*
+ * Selects a channel that is neither occupied in the own SAB nor in the sub block (if given), starting at a random channel.
+ */
+bool GTSHelper::selectFreeChannel(GTS& gts, const DSMESABSpecification* sabSpec) {
+    DSMESlotAllocationBitmap& macDSMESAB = this->dsmeAdaptionLayer.getMAC_PIB().macDSMESAB;
+    uint8_t numChannels = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumChannels();
+
+    BitVector<MAX_CHANNELS> occupied;
+    occupied.setLength(numChannels);
+    macDSMESAB.getOccupiedChannels(occupied, gts.superframeID, gts.slotID);
+    if(sabSpec != nullptr) {
+        BitVector<MAX_CHANNELS> remoteOccupied;
+        remoteOccupied.setLength(numChannels);
+        remoteOccupied.copyFrom(sabSpec->getSubBlock(), gts.slotID * numChannels);
+        occupied.setOperationJoin(remoteOccupied);
+    }
+
+    gts.channel = this->dsmeAdaptionLayer.getDSME().getPlatform().getRandom() % numChannels;
+    for(uint8_t i = 0; i < numChannels; i++) {
+        if(!occupied.get(gts.channel)) {
+            return true;
+        }
+
+        gts.channel++;
+        if(gts.channel == numChannels) {
+            gts.channel = 0;
+        }
+    }
+    return false;
+}
+
+GTSStatus::GTS_Status GTSHelper::verifyDeallocation(DSMESABSpecification& requestSABSpec, uint16_t& deviceAddress, Direction& direction) {
     DSMEAllocationCounterTable& macDSMEACT = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT;
 
     uint8_t numChannels = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumChannels();
 
-    bool foundGts = false;
-    bool gtsDifferentAddresses = false;
+    DSMESABSpecification::SABSubBlock verified;
+    verified.setLength(requestSABSpec.getSubBlock().length());
+    verified.fill(false);
 
     for(DSMEAllocationCounterTable::iterator it = macDSMEACT.begin(); it != macDSMEACT.end(); ++it) {
         abs_slot_idx_t idx = it->getGTSlotID();
@@ -448,29 +561,22 @@ GTSStatus::GTS_Status GTSHelper::verifyDeallocation(DSMESABSpecification& reques
         if(deviceAddress == IEEE802154MacAddress::NO_SHORT_ADDRESS) {
             deviceAddress = it->getAddress();
             direction = it->getDirection();
-            foundGts = true;
-        } else if(deviceAddress == it->getAddress()) {
-            foundGts = true;
-        } else {
-            DSME_ASSERT(!foundGts); // currently deallocation is only possible with one slot
-            gtsDifferentAddresses = true;
+        } else if(deviceAddress != it->getAddress()) {
+            // TODO This could also mean that the slot is in use with another node
+            LOG_INFO("Slot to deallocate is used with another device, excluded from deallocation.");
+            continue;
         }
-    }
 
-    if(gtsDifferentAddresses) {
-        // TODO handle multiple requests or also send (INVALID_PARAMETER)?!
-        // DSME_ASSERT(false); // TODO ?
-        // TODO This could also mean that the slot is in use with another node, better DENIED?
-        return GTSStatus::DENIED;
+        verified.set(idx, true);
     }
 
-    if(foundGts) {
-        result = GTSStatus::SUCCESS;
-    } else {
-        result = GTSStatus::DENIED;
+    if(verified.isZero()) {
+        return GTSStatus::DENIED;
     }
 
-    return result;
+    // Only the slots that are actually allocated with the requesting device are deallocated (partial approval)
+    requestSABSpec.getSubBlock() = verified;
+    return GTSStatus::SUCCESS;
 }
 
 void GTSHelper::findFreeSlots(DSMESABSpecification& requestSABSpec, DSMESABSpecification& replySABSpec, uint8_t numSlots, uint16_t preferredSuperframe,
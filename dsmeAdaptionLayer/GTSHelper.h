@@ -69,14 +69,24 @@ public:
 
     void reset();
 
-    void checkAllocationForPacket(uint16_t address);
+    /**
+     * Checks if the allocation for a link has to be changed because of a new packet
+     * @param address the destination of the packet
+     * @param priority HIGH for critical packets, the allocation is then requested with prioritized channel access if enabled
+     */
+    void checkAllocationForPacket(uint16_t address, Priority priority = Priority::LOW);
 
     uint8_t indicateIncomingMessage(uint16_t address);
     void indicateOutgoingMessage(uint16_t address, bool success, int32_t serviceTime, uint8_t queueAtCreation);
     void indicateReceivedMessage(uint16_t address);
+    void indicateDeadlineMiss(uint16_t address);
 
     void handleStartOfCFP();
 
+    void handleAllocationChanged(uint16_t address, Direction direction);
+
+    void reportSlotTarget(uint16_t address, int16_t slotTarget);
+
 private:
     /* MLME handlers */
 
@@ -92,7 +102,7 @@ private:
 
     void checkAndAllocateGTS(GTSSchedulingDecision decision);
 
-    void checkAndDeallocateSingeleGTS(uint16_t address);
+    void checkAndDeallocateGTS(uint16_t address, uint8_t numSlots);
 
     GTS getContiguousFreeGTS();
 
@@ -100,6 +110,12 @@ private:
 
     GTS getNextFreeGTS(uint16_t initialSuperframeID, uint8_t initialSlotID, const DSMESABSpecification* sabSpec = nullptr);
 
+    /**
+     * In contrast to getNextFreeGTS, the search does not wrap around within the initial superframe,
+     * but continues with the first slot of the next superframe, so the result is the first free slot in time.
+     */
+    GTS getFollowingFreeGTS(uint16_t initialSuperframeID, uint8_t initialSlotID);
+
     GTSStatus::GTS_Status verifyDeallocation(DSMESABSpecification& requestSABSpec, uint16_t& deviceAddress, Direction& direction);
 
     void findFreeSlots(DSMESABSpecification& requestSABSpec, DSMESABSpecification& replySABSpec, uint8_t numSlots, uint16_t preferredSuperframe,
@@ -107,7 +123,14 @@ private:
 
     void sendDeallocationRequest(uint16_t address, Direction direction, DSMESABSpecification& sabSpecification);
 
+    /**
+     * Returns the scheduling action for the first link with critical packets in its queue, if prioritized channel access is enabled
+     */
+    GTSSchedulingDecision getUrgentSchedulingAction();
+
 private:
+    bool selectFreeChannel(GTS& gts, const DSMESABSpecification* sabSpec);
+
     DSMEAdaptionLayer& dsmeAdaptionLayer;
 
     GTSScheduling* gtsScheduling = nullptr;
@@ -176,6 +176,14 @@ void MessageHelper::sendMessageDown(IDSMEMessage* msg, bool newMessage) {
 
         params.sendMultipurpose = false;
 
+        params.trafficClass = static_cast<TrafficClass::Traffic_Class>(msg->trafficClass);
+
+        /* critical traffic has to be delivered within macCritMsgDelayTol, a new message starts a new transaction */
+        params.criticalEventMessage = (msg->trafficClass == TrafficClass::CRITICAL);
+        if(newMessage) {
+            msg->hasDeadline = false;
+        }
+
         if(params.gtsTx) {
             uint16_t srcAddr = this->dsmeAdaptionLayer.getMAC_PIB().macShortAddress;
             if(srcAddr == 0xfffe) {
@@ -193,7 +201,7 @@ void MessageHelper::sendMessageDown(IDSMEMessage* msg, bool newMessage) {
             if(newMessage) {
                 msg->setStartOfFrameDelimiterSymbolCounter(this->dsmeAdaptionLayer.getDSME().getPlatform().getSymbolCounter()); // MISSUSE for statistics
                 msg->queueAtCreation = this->dsmeAdaptionLayer.getGTSHelper().indicateIncomingMessage(dst.getShortAddress());
-                this->dsmeAdaptionLayer.getGTSHelper().checkAllocationForPacket(dst.getShortAddress());
+                this->dsmeAdaptionLayer.getGTSHelper().checkAllocationForPacket(dst.getShortAddress(), (msg->trafficClass == TrafficClass::CRITICAL) ? Priority::HIGH : Priority::LOW);
             }
 
             LOG_DEBUG("Preparing transmission in CFP.");
@@ -283,6 +291,13 @@ void MessageHelper::handleDataConfirm(mcps_sap::DATA_confirm_parameters& params)
         // TODO verify that Ack in GTS is always successful for simulation
     }
 
+    if(params.gtsTX && msg->hasDeadline) {
+        int32_t lateness = (int32_t) this->dsmeAdaptionLayer.getDSME().getPlatform().getSymbolCounter() - (int32_t)msg->deadline;
+        if(params.status == DataStatus::TRANSACTION_EXPIRED || lateness > 0) {
+            this->dsmeAdaptionLayer.getGTSHelper().indicateDeadlineMiss(msg->getHeader().getDestAddr().getShortAddress());
+        }
+    }
+
     if(params.gtsTX) {
         int32_t serviceTime =
             (int32_t) this->dsmeAdaptionLayer.getDSME().getPlatform().getSymbolCounter() - (int32_t)msg->getStartOfFrameDelimiterSymbolCounter();
@@ -43,24 +43,61 @@
 #ifndef GTSSCHEDULING_H_
 #define GTSSCHEDULING_H_
 
+#include "../../../dsme_settings.h"
+#include "../../helper/DSMEDelegate.h"
 #include "../../mac_services/DSME_Common.h"
 #include "../../mac_services/dataStructures/IEEE802154MacAddress.h"
 #include "../../mac_services/dataStructures/RBTree.h"
+#include "./SchedulingArithmetic.h"
 
 namespace dsme {
 
 class DSMEAdaptionLayer;
 
 struct GTSSchedulingData {
-    GTSSchedulingData() : address(0xffff), messagesInLastMultisuperframe(0), messagesOutLastMultisuperframe(0), slotTarget(1) {
+    GTSSchedulingData()
+        : address(0xffff),
+          messagesInLastMultisuperframe(0),
+          messagesOutLastMultisuperframe(0),
+          deadlineMissesLastMultisuperframe(0),
+          slotTarget(1),
+          priority(0) {
     }
 
     uint16_t address;
 
     uint16_t messagesInLastMultisuperframe;
     uint16_t messagesOutLastMultisuperframe;
+    uint16_t deadlineMissesLastMultisuperframe;
 
     int16_t slotTarget;
+    uint16_t priority; // |slotTarget - allocated| as stored in the priority tree, 0 if not contained
+};
+
+/*
+ * Orders links by decreasing priority, so the link with the highest priority is the minimum
+ */
+struct GTSSchedulingPriority {
+    uint16_t priority;
+    uint16_t address;
+
+    bool operator>(const GTSSchedulingPriority& other) const {
+        if(this->priority != other.priority) {
+            return this->priority < other.priority;
+        }
+        return this->address > other.address;
+    }
+
+    bool operator<(const GTSSchedulingPriority& other) const {
+        if(this->priority != other.priority) {
+            return this->priority > other.priority;
+        }
+        return this->address < other.address;
+    }
+
+    bool operator==(const GTSSchedulingPriority& other) const {
+        return ((priority == other.priority) && (address == other.address));
+    }
 };
 
 struct GTSRxData {
@@ -68,6 +105,14 @@ struct GTSRxData {
     uint16_t messagesRxLastMultisuperframe = 0;
 };
 
+/*
+ * Tells the GTSHelper where to continue if the preferred slot is not free
+ */
+enum class GTSPlacementHint : uint8_t {
+    NEAREST,  /* any free slot close to the preferred one, the search wraps around within the preferred superframe */
+    FOLLOWING /* the first free slot at or after the preferred one in time, possibly in a later superframe */
+};
+
 /*
  * This is compatible to the parameters of MLME-DSME-GTS.request
  */
@@ -78,9 +123,12 @@ struct GTSSchedulingDecision {
     uint8_t numSlot;
     uint16_t preferredSuperframeId;
     uint8_t preferredSlotId;
+    GTSPlacementHint placementHint;
+    Priority priority; /* HIGH for links with critical traffic if prioritized channel access is enabled */
 };
 
-static constexpr GTSSchedulingDecision NO_SCHEDULING_ACTION{IEEE802154MacAddress::NO_SHORT_ADDRESS, ManagementType::ALLOCATION, Direction::TX, 0, 0, 0};
+static constexpr GTSSchedulingDecision NO_SCHEDULING_ACTION{IEEE802154MacAddress::NO_SHORT_ADDRESS, ManagementType::ALLOCATION, Direction::TX, 0, 0, 0,
+                                                            GTSPlacementHint::NEAREST, Priority::LOW};
 
 class GTSScheduling {
 public:
@@ -92,20 +140,25 @@ public:
     virtual uint8_t registerIncomingMessage(uint16_t address) = 0;
     virtual void registerOutgoingMessage(uint16_t address, bool success, int32_t serviceTime, uint8_t queueAtCreation) = 0;
     virtual void registerReceivedMessage(uint16_t address) = 0;
+    virtual void registerDeadlineMiss(uint16_t address) = 0;
+    virtual void registerAllocationChange(uint16_t address, Direction direction) = 0;
     virtual void multisuperframeEvent() = 0;
     virtual int16_t getSlotTarget(uint16_t address) = 0;
     virtual uint16_t getPriorityLink() = 0;
     virtual GTSSchedulingDecision getNextSchedulingAction(uint16_t address) = 0;
     virtual GTSSchedulingDecision getNextSchedulingAction() = 0;
+    virtual void getSlotTargets(Delegate<void(uint16_t, int16_t)> delegate) = 0;
 
 protected:
     DSMEAdaptionLayer& dsmeAdaptionLayer;
 };
 
-template <typename SchedulingData, typename RxData>
+template <typename SchedulingData, typename RxData, typename Arithmetic = FloatArithmetic>
 class GTSSchedulingImpl : public GTSScheduling {
 public:
     typedef typename RBTree<SchedulingData, uint16_t>::iterator iterator;
+    typedef Arithmetic arithmetic_t;
+    typedef typename Arithmetic::value_t value_t;
 
     GTSSchedulingImpl(DSMEAdaptionLayer& dsmeAdaptionLayer) : GTSScheduling(dsmeAdaptionLayer) {
     }
@@ -121,6 +174,10 @@ public:
             auto it = this->rxLinks.begin();
             this->rxLinks.remove(it);
         }
+        while(this->priorities.size() > 0) {
+            auto it = this->priorities.begin();
+            this->priorities.remove(it);
+        }
     }
 
     virtual uint8_t registerIncomingMessage(uint16_t address) {
@@ -131,6 +188,7 @@ public:
             data.address = address;
             data.messagesInLastMultisuperframe++;
             this->txLinks.insert(data, address);
+            updatePriority(*this->txLinks.find(address));
         } else {
             it->messagesInLastMultisuperframe++;
         }
@@ -159,12 +217,45 @@ public:
         }
     }
 
+    /*
+     * Called if a message to the given address was not delivered before its deadline.
+     * The implementations should request additional capacity for links that keep missing.
+     */
+    virtual void registerDeadlineMiss(uint16_t address) {
+        iterator it = this->txLinks.find(address);
+        if(it != this->txLinks.end() && it->deadlineMissesLastMultisuperframe < 0xFFFF) {
+            it->deadlineMissesLastMultisuperframe++;
+        }
+    }
+
+    /*
+     * Called whenever a slot was added to or removed from the ACT.
+     */
+    virtual void registerAllocationChange(uint16_t address, Direction direction) {
+        if(direction != Direction::TX) {
+            return;
+        }
+        iterator it = this->txLinks.find(address);
+        if(it != this->txLinks.end()) {
+            updatePriority(*it);
+        }
+    }
+
     virtual int16_t getSlotTarget(uint16_t address) {
         iterator it = this->txLinks.find(address);
 
         return it->slotTarget;
     }
 
+    /*
+     * Hands the slot target of every TX link to the delegate, e.g. to report them for the central scheduling.
+     */
+    virtual void getSlotTargets(Delegate<void(uint16_t, int16_t)> delegate) {
+        for(SchedulingData& data : this->txLinks) {
+            delegate(data.address, data.slotTarget);
+        }
+    }
+
     static uint16_t abs(int16_t v) {
         if(v > 0) {
             return v;
@@ -173,18 +264,16 @@ public:
         }
     }
 
+    /*
+     * Returns the link with the largest difference between slot target and allocated slots.
+     * The priorities are kept up to date by updatePriority, so no link has to be inspected here.
+     */
     uint16_t getPriorityLink() {
-        uint16_t address = IEEE802154MacAddress::NO_SHORT_ADDRESS;
-        int16_t difference = 0;
-        for(const SchedulingData& d : this->txLinks) {
-            uint16_t slots = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.getNumAllocatedGTS(d.address, Direction::TX);
-
-            if(abs(difference) < abs(d.slotTarget - slots)) {
-                difference = d.slotTarget - slots;
-                address = d.address;
-            }
+        auto it = this->priorities.min();
+        if(it == this->priorities.end()) {
+            return IEEE802154MacAddress::NO_SHORT_ADDRESS;
         }
-        return address;
+        return *it;
     }
 
     virtual GTSSchedulingDecision getNextSchedulingAction(uint16_t address) {
@@ -193,16 +282,29 @@ public:
         int16_t target = getSlotTarget(address);
 
         if(target > numAllocatedSlots) {
-            uint8_t numSuperFramesPerMultiSuperframe = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe();
-            uint8_t randomSuperframeID = this->dsmeAdaptionLayer.getRandom() % numSuperFramesPerMultiSuperframe;
-
-            uint8_t numGTSlots = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumGTSlots(randomSuperframeID);
-            uint8_t randomSlotID = this->dsmeAdaptionLayer.getRandom() % numGTSlots;
+            /* the whole difference is requested at once, the replier grants as many slots as are free in the preferred superframe */
+            uint8_t numSlots = getNumSlotsPerRequest(target - numAllocatedSlots);
+
+            uint16_t superframeID;
+            uint8_t slotID;
+            if(this->spreadSlots && this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.getSpreadSlot(address, Direction::TX, superframeID, slotID)) {
+                /* '-> the replier grants the slots following the preferred one, so only a single slot keeps the allocation spread */
+                numSlots = 1;
+            } else {
+                uint8_t numSuperFramesPerMultiSuperframe = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe();
+                superframeID = this->dsmeAdaptionLayer.getRandom() % numSuperFramesPerMultiSuperframe;
+
+                uint8_t numGTSlots = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumGTSlots(superframeID);
+                slotID = this->dsmeAdaptionLayer.getRandom() % numGTSlots;
+            }
 
-            return GTSSchedulingDecision{address, ManagementType::ALLOCATION, Direction::TX, 1, randomSuperframeID, randomSlotID};
+            return GTSSchedulingDecision{address, ManagementType::ALLOCATION, Direction::TX, numSlots, superframeID, slotID, GTSPlacementHint::NEAREST,
+                                         Priority::LOW};
         } else if(target < numAllocatedSlots && numAllocatedSlots > 1) {
             /* TODO: slot and superframe ID are currently ignored for DEALLOCATION */
-            return GTSSchedulingDecision{address, ManagementType::DEALLOCATION, Direction::TX, 1, 0, 0};
+            int16_t excess = numAllocatedSlots - ((target > 1) ? target : 1);
+            return GTSSchedulingDecision{address, ManagementType::DEALLOCATION, Direction::TX, getNumSlotsPerRequest(excess), 0, 0, GTSPlacementHint::NEAREST,
+                                         Priority::LOW};
         } else {
             return NO_SCHEDULING_ACTION;
         }
@@ -217,10 +319,55 @@ public:
         }
     }
 
+    /*
+     * Limits the number of slots that are allocated or deallocated within a single DSME-GTS handshake.
+     */
+    void setMaxSlotsPerRequest(uint8_t maxSlotsPerRequest) {
+        this->maxSlotsPerRequest = (maxSlotsPerRequest > 0) ? maxSlotsPerRequest : 1;
+    }
+
+    /*
+     * Places additional slots of a link as far as possible from its existing slots instead of at a random position.
+     * The first slot of a link is always placed randomly. Disabled by default, since a spread allocation
+     * grows by a single slot per handshake, so a link takes one handshake per missing slot to reach its target.
+     */
+    void setSpreadSlots(bool spreadSlots) {
+        this->spreadSlots = spreadSlots;
+    }
+
 protected:
+    /*
+     * Has to be called after the slot target of a link was changed.
+     */
+    void updatePriority(SchedulingData& data) {
+        uint16_t slots = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.getNumAllocatedGTS(data.address, Direction::TX);
+        uint16_t priority = abs(data.slotTarget - slots);
+        if(priority == data.priority) {
+            return;
+        }
+
+        if(data.priority > 0) {
+            auto it = this->priorities.find(GTSSchedulingPriority{data.priority, data.address});
+            if(it != this->priorities.end()) {
+                this->priorities.remove(it);
+            }
+        }
+        if(priority > 0) {
+            this->priorities.insert(data.address, GTSSchedulingPriority{priority, data.address});
+        }
+        data.priority = priority;
+    }
+
+    uint8_t getNumSlotsPerRequest(int16_t difference) const {
+        return (difference < this->maxSlotsPerRequest) ? difference : this->maxSlotsPerRequest;
+    }
+
     RBTree<SchedulingData, uint16_t> txLinks;
     RBTree<RxData, uint16_t> rxLinks;
+    RBTree<uint16_t, GTSSchedulingPriority> priorities; // addresses of the links with slotTarget != allocated
     uint8_t queueLevel = 0;
+    uint8_t maxSlotsPerRequest = MAX_GTSLOTS;
+    bool spreadSlots = false;
 };
 
 } /* namespace dsme */
@@ -47,22 +47,24 @@
 #include "../../mac_services/pib/MAC_PIB.h"
 #include "../DSMEAdaptionLayer.h"
 
-constexpr int16_t K_P_POS = 0;
-constexpr int16_t K_I_POS = 30;
-constexpr int16_t K_D_POS = 26;
-
-constexpr int16_t K_P_NEG = 50;
-constexpr int16_t K_I_NEG = 30;
-constexpr int16_t K_D_NEG = 38;
-
-constexpr uint16_t SCALING = 128;
-
 namespace dsme {
 
 PIDSchedulingData::PIDSchedulingData() : error_sum(0), last_error(0) {
 }
 
-void PIDScheduling::multisuperframeEvent() {
+template <typename Arithmetic>
+void PIDSchedulingImpl<Arithmetic>::setGains(const PIDGains& gains) {
+    int32_t scaling = (int32_t)1 << gains.fractionalBits;
+    kPPos = Arithmetic::fromRatio(gains.pPos, scaling);
+    kIPos = Arithmetic::fromRatio(gains.iPos, scaling);
+    kDPos = Arithmetic::fromRatio(gains.dPos, scaling);
+    kPNeg = Arithmetic::fromRatio(gains.pNeg, scaling);
+    kINeg = Arithmetic::fromRatio(gains.iNeg, scaling);
+    kDNeg = Arithmetic::fromRatio(gains.dNeg, scaling);
+}
+
+template <typename Arithmetic>
+void PIDSchedulingImpl<Arithmetic>::multisuperframeEvent() {
     for(PIDSchedulingData& data : this->txLinks) {
         uint16_t w = data.messagesInLastMultisuperframe;
         uint16_t y = data.messagesOutLastMultisuperframe;
@@ -75,9 +77,14 @@ void PIDScheduling::multisuperframeEvent() {
         i += e;
 
         if(e > 0) {
-            u = (K_P_POS * e + K_I_POS * i + K_D_POS * d) / SCALING;
+            u = SchedulingControl<Arithmetic>::pid(kPPos, kIPos, kDPos, e, i, d);
         } else {
-            u = (K_P_NEG * e + K_I_NEG * i + K_D_NEG * d) / SCALING;
+            u = SchedulingControl<Arithmetic>::pid(kPNeg, kINeg, kDNeg, e, i, d);
+        }
+
+        if(data.deadlineMissesLastMultisuperframe > 0 && u < 1) {
+            /* '-> the link keeps missing deadlines, request an additional slot */
+            u = 1;
         }
 
         uint16_t slots = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.getNumAllocatedGTS(data.address, Direction::TX);
@@ -100,7 +107,13 @@ void PIDScheduling::multisuperframeEvent() {
         data.last_error = e;
         data.messagesInLastMultisuperframe = 0;
         data.messagesOutLastMultisuperframe = 0;
+        data.deadlineMissesLastMultisuperframe = 0;
+
+        this->updatePriority(data);
     }
 }
 
+template class PIDSchedulingImpl<FixedPointArithmetic<SCHEDULING_FRACTIONAL_BITS>>;
+template class PIDSchedulingImpl<FloatArithmetic>;
+
 } /* namespace dsme */
@@ -56,14 +56,50 @@ struct PIDSchedulingData : GTSSchedulingData {
     int16_t last_error;
 };
 
-class PIDScheduling : public GTSSchedulingImpl<PIDSchedulingData, GTSRxData> {
+/*
+ * Controller gains in Q-format, i.e. the actual gain is value / 2^fractionalBits.
+ * Separate gains are used for positive and negative errors.
+ */
+struct PIDGains {
+    int16_t pPos;
+    int16_t iPos;
+    int16_t dPos;
+    int16_t pNeg;
+    int16_t iNeg;
+    int16_t dNeg;
+    uint8_t fractionalBits;
+};
+
+static constexpr PIDGains DEFAULT_PID_GAINS{0, 30, 26, 50, 30, 38, 7};
+
+/*
+ * The Arithmetic selects between the fixed-point variant (PIDScheduling) and the float reference (FloatPIDScheduling),
+ * both are explicitly instantiated in PIDScheduling.cc.
+ */
+template <typename Arithmetic>
+class PIDSchedulingImpl : public GTSSchedulingImpl<PIDSchedulingData, GTSRxData, Arithmetic> {
 public:
-    PIDScheduling(DSMEAdaptionLayer& dsmeAdaptionLayer) : GTSSchedulingImpl(dsmeAdaptionLayer) {
+    typedef typename Arithmetic::value_t value_t;
+
+    PIDSchedulingImpl(DSMEAdaptionLayer& dsmeAdaptionLayer) : GTSSchedulingImpl<PIDSchedulingData, GTSRxData, Arithmetic>(dsmeAdaptionLayer) {
+        setGains(DEFAULT_PID_GAINS);
     }
 
     virtual void multisuperframeEvent();
+    void setGains(const PIDGains& gains);
+
+private:
+    value_t kPPos;
+    value_t kIPos;
+    value_t kDPos;
+    value_t kPNeg;
+    value_t kINeg;
+    value_t kDNeg;
 };
 
+typedef PIDSchedulingImpl<FixedPointArithmetic<SCHEDULING_FRACTIONAL_BITS>> PIDScheduling;
+typedef PIDSchedulingImpl<FloatArithmetic> FloatPIDScheduling;
+
 } /* namespace dsme */
 
 #endif /* PIDSCHEDULING_H_ */
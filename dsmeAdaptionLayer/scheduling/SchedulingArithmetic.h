@@ -0,0 +1,217 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef SCHEDULINGARITHMETIC_H_
+#define SCHEDULINGARITHMETIC_H_
+
+#include <cmath>
+#include "../../helper/Integers.h"
+
+namespace dsme {
+
+/*
+ * Number of fractional bits of the fixed-point variants of the schedulers (Q15.16 by default)
+ */
+#ifndef DSME_SCHEDULING_FRACTIONAL_BITS
+#define DSME_SCHEDULING_FRACTIONAL_BITS 16
+#endif
+constexpr uint8_t SCHEDULING_FRACTIONAL_BITS{DSME_SCHEDULING_FRACTIONAL_BITS};
+
+/*
+ * Arithmetic of the scheduling controllers, selected via the template parameter of GTSSchedulingImpl.
+ * The float variant is the reference, the fixed-point variant avoids software floating point on MCUs without FPU.
+ */
+struct FloatArithmetic {
+    typedef float value_t;
+
+    static value_t fromInt(int32_t v) {
+        return v;
+    }
+
+    static value_t fromRatio(int32_t numerator, int32_t denominator) {
+        return (float)numerator / denominator;
+    }
+
+    /* only intended for configuration, not for the periodic computations */
+    static value_t fromFloat(float v) {
+        return v;
+    }
+
+    static value_t mul(value_t a, value_t b) {
+        return a * b;
+    }
+
+    static value_t div(value_t a, value_t b) {
+        return a / b;
+    }
+
+    static value_t scale(value_t v, int32_t numerator, int32_t denominator) {
+        return v * numerator / denominator;
+    }
+
+    static int32_t ceil(value_t v) {
+        return std::ceil(v);
+    }
+
+    static int32_t trunc(value_t v) {
+        return v;
+    }
+
+    /* only intended for logging */
+    static float toFloat(value_t v) {
+        return v;
+    }
+};
+
+/*
+ * Signed Q(31-F).F fixed-point numbers. mul rounds to nearest and div towards zero,
+ * so every operation deviates by at most one unit in the last place from the exact result.
+ */
+template <uint8_t F>
+struct FixedPointArithmetic {
+    static_assert(F > 0 && F < 31, "invalid number of fractional bits");
+
+    typedef int32_t value_t;
+
+    static constexpr value_t ONE = (value_t)1 << F;
+
+    static value_t fromInt(int32_t v) {
+        return v * ONE;
+    }
+
+    static value_t fromRatio(int32_t numerator, int32_t denominator) {
+        return (int64_t)numerator * ONE / denominator;
+    }
+
+    /* only intended for configuration, not for the periodic computations */
+    static value_t fromFloat(float v) {
+        return (value_t)(v * ONE + ((v < 0) ? -0.5f : 0.5f));
+    }
+
+    static value_t mul(value_t a, value_t b) {
+        return ((int64_t)a * b + (ONE >> 1)) >> F;
+    }
+
+    static value_t div(value_t a, value_t b) {
+        return (int64_t)a * ONE / b;
+    }
+
+    /* v * numerator / denominator without overflow or rounding of the intermediate result */
+    static value_t scale(value_t v, int32_t numerator, int32_t denominator) {
+        return (int64_t)v * numerator / denominator;
+    }
+
+    static int32_t ceil(value_t v) {
+        if(v >= 0) {
+            return (v + ONE - 1) >> F;
+        } else {
+            return -((-v) >> F);
+        }
+    }
+
+    static int32_t trunc(value_t v) {
+        if(v >= 0) {
+            return v >> F;
+        } else {
+            return -((-v) >> F);
+        }
+    }
+
+    /* only intended for logging */
+    static float toFloat(value_t v) {
+        return (float)v / ONE;
+    }
+};
+
+template <uint8_t F>
+constexpr typename FixedPointArithmetic<F>::value_t FixedPointArithmetic<F>::ONE;
+
+/*
+ * Computation steps of the TPS and PID controllers. They only depend on the arithmetic,
+ * so both variants can be compared without the rest of the stack (see utils/scheduling_arithmetic).
+ */
+template <typename Arithmetic>
+struct SchedulingControl {
+    typedef typename Arithmetic::value_t value_t;
+
+    /* the smoothing factor is a ratio with this denominator, a Q(F) factor would dominate the error of the average */
+    static constexpr int32_t ALPHA_DENOMINATOR = (int32_t)1 << 30;
+
+    static int32_t alphaFromFloat(float alpha) {
+        return (int32_t)(alpha * ALPHA_DENOMINATOR + 0.5f);
+    }
+
+    /* exponential moving average of the messages per multi-superframe, with a single rounding per update */
+    static value_t average(value_t avg, uint16_t messages, int32_t alpha) {
+        return avg + Arithmetic::scale(Arithmetic::fromInt(messages) - avg, alpha, ALPHA_DENOMINATOR);
+    }
+
+    /* avg / capacity - slots with capacity = packetsPerSlot * etxOne / etx, in one step to keep the fixed-point error small */
+    static value_t tpsError(value_t avg, uint16_t etx, uint16_t packetsPerSlot, uint16_t etxOne, uint8_t slots) {
+        return Arithmetic::scale(avg, etx, (int32_t)packetsPerSlot * etxOne) - Arithmetic::fromInt(slots);
+    }
+
+    /* change of the number of slots, the hysteresis only releases slots if more than two are unused */
+    static int8_t tpsChange(value_t error, bool useHysteresis) {
+        if(!useHysteresis) {
+            return Arithmetic::ceil(error);
+        } else if(error > 0) {
+            return Arithmetic::ceil(error);
+        } else if(error < Arithmetic::fromInt(-2)) {
+            return Arithmetic::ceil(error) + 1;
+        } else {
+            return 0;
+        }
+    }
+
+    static int16_t pid(value_t kP, value_t kI, value_t kD, int16_t e, int16_t i, int16_t d) {
+        return Arithmetic::trunc(Arithmetic::mul(kP, Arithmetic::fromInt(e)) + Arithmetic::mul(kI, Arithmetic::fromInt(i)) +
+                                 Arithmetic::mul(kD, Arithmetic::fromInt(d)));
+    }
+};
+
+template <typename Arithmetic>
+constexpr int32_t SchedulingControl<Arithmetic>::ALPHA_DENOMINATOR;
+
+} /* namespace dsme */
+
+#endif /* SCHEDULINGARITHMETIC_H_ */
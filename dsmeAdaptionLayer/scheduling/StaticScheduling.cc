@@ -62,6 +62,7 @@ void StaticScheduling::multisuperframeEvent() {
     // Set priority for the right links 
     for(GTSSchedulingData &data : this->txLinks) {
         data.slotTarget = std::count(this->addresses.begin(), this->addresses.end(), data.address);
+        updatePriority(data);
     }
 
     this->newMsf = true;
@@ -74,7 +75,8 @@ GTSSchedulingDecision StaticScheduling::getNextSchedulingAction(uint16_t address
             if(this->newMsf && this->addresses[i] == address) {
                 if(!this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.isAllocated(this->superframes[i], this->slots[i])) {
                     this->newMsf = false;
-                    return GTSSchedulingDecision{address, ManagementType::ALLOCATION, Direction::TX, 1, this->superframes[i], this->slots[i]};
+                    return GTSSchedulingDecision{address, ManagementType::ALLOCATION, Direction::TX, 1, this->superframes[i], this->slots[i],
+                                                 GTSPlacementHint::NEAREST, Priority::LOW};
                 }
             }
         }
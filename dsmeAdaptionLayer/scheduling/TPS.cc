@@ -42,9 +42,11 @@
 
 #include "./TPS.h"
 
-#include <cmath>
 #include "../../../dsme_platform.h"
 #include "../../dsmeLayer/DSMELayer.h"
+#include "../../dsmeLayer/messageDispatcher/MessageDispatcher.h"
+#include "../../mac_services/dataStructures/LinkCapacityTable.h"
+#include "../../mac_services/dataStructures/LinkQualityTable.h"
 #include "../../mac_services/dataStructures/IEEE802154MacAddress.h"
 #include "../../mac_services/pib/MAC_PIB.h"
 #include "../DSMEAdaptionLayer.h"
@@ -53,26 +55,32 @@ static bool header = false;
 
 namespace dsme {
 
-TPSTxData::TPSTxData() : avgIn(0), multisuperframesSinceLastPacket(0) {
+template <typename Arithmetic>
+TPSTxDataImpl<Arithmetic>::TPSTxDataImpl() : avgIn(0), multisuperframesSinceLastPacket(0) {
 }
 
-void TPS::setAlpha(float alpha) {
-    this->alpha = alpha;
+template <typename Arithmetic>
+void TPSImpl<Arithmetic>::setAlpha(float alpha) {
+    this->alpha = SchedulingControl<Arithmetic>::alphaFromFloat(alpha);
 }
 
-void TPS::setMinFreshness(uint16_t minFreshness) {
+template <typename Arithmetic>
+void TPSImpl<Arithmetic>::setMinFreshness(uint16_t minFreshness) {
     this->minFreshness = minFreshness;
 }
 
-void TPS::setUseHysteresis(bool useHysteresis) {
+template <typename Arithmetic>
+void TPSImpl<Arithmetic>::setUseHysteresis(bool useHysteresis) {
     this->useHysteresis = useHysteresis;
 }
 
-void TPS::setUseMultiplePacketsPerGTS(bool useMultiplePackets) {
+template <typename Arithmetic>
+void TPSImpl<Arithmetic>::setUseMultiplePacketsPerGTS(bool useMultiplePackets) {
     this->useMultiplePacketsPerGTS = useMultiplePackets;
 }
 
-void TPS::multisuperframeEvent() {
+template <typename Arithmetic>
+void TPSImpl<Arithmetic>::multisuperframeEvent() {
     if(!header) {
         LOG_DEBUG("control"
                   << ","
@@ -95,38 +103,46 @@ void TPS::multisuperframeEvent() {
         header = true;
     }
 
-    for(TPSTxData& data : this->txLinks) {
+    for(TPSTxDataImpl<Arithmetic>& data : this->txLinks) {
         DSME_ASSERT(alpha > 0);
         DSME_ASSERT(minFreshness > 0);
-        data.avgIn = data.messagesInLastMultisuperframe * alpha + data.avgIn * (1 - alpha);
+        data.avgIn = SchedulingControl<Arithmetic>::average(data.avgIn, data.messagesInLastMultisuperframe, alpha);
 
         uint8_t slots = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.getNumAllocatedGTS(data.address, Direction::TX);
 
-        //LengthFrameInSymbols = Preamble +SFD + PHR + PSDU (PHYPayload)
-        //Preamble = 8 symbols;
-        //SFD = 2 symbols;
-        //PHR = 2 symbols;
-        //PSDU = MHR + MACPayload + MFR;
         uint8_t packets_per_slot = 1;
         if(useMultiplePacketsPerGTS) {
-            packets_per_slot = (this->dsmeAdaptionLayer.getMAC_PIB().helper.getSymbolsPerSlot() - PRE_EVENT_SHIFT) / ((6 + 127)*2 + this->dsmeAdaptionLayer.getMAC_PIB().helper.getAckWaitDuration() + const_redefines::macLIFSPeriod);
-                /* '-> calculate number of packets per slot with assumption of maximum packet size and maximum acknowledgement wait duration -> THIS CAN BE DONE MUCH BETTER */
+            //LengthFrameInSymbols = Preamble +SFD + PHR + PSDU (PHYPayload)
+            //Preamble = 8 symbols;
+            //SFD = 2 symbols;
+            //PHR = 2 symbols;
+            //PSDU = MHR + MACPayload + MFR;
+            uint32_t usableSymbols = this->dsmeAdaptionLayer.getMAC_PIB().helper.getSymbolsPerSlot() - PRE_EVENT_SHIFT;
+            uint8_t worstCase = usableSymbols / ((6 + 127) * 2 + this->dsmeAdaptionLayer.getMAC_PIB().helper.getAckWaitDuration() + const_redefines::macLIFSPeriod);
+            /* '-> maximum packet size and maximum acknowledgement wait duration, only used until the link was measured */
+
+            LinkCapacityTable& linkCapacity = this->dsmeAdaptionLayer.getDSME().getMessageDispatcher().getLinkCapacityTable();
+            packets_per_slot = linkCapacity.getAttemptsPerSlot(data.address, usableSymbols, worstCase > 0 ? worstCase : 1);
         }
 
-        LOG_DEBUG("Packets per slot: " << (int)packets_per_slot);
-        float error = (data.avgIn / packets_per_slot) - slots;
-        LOG_DEBUG("TPS error: " << error);
+        /* every frame occupies the slot for ETX attempts, but never for more attempts than the retry budget allows */
+        LinkQualityTable& linkQuality = this->dsmeAdaptionLayer.getDSME().getMessageDispatcher().getLinkQualityTable();
+        uint8_t maxAttempts = linkQuality.getRetryBudget(data.address, LinkQualityTable::ALL_CHANNELS, this->dsmeAdaptionLayer.getMAC_PIB().macMaxFrameRetries) + 1;
+        uint16_t etx = linkQuality.getETX(data.address);
+        if(etx > maxAttempts * LinkQualityTable::ETX_ONE) {
+            etx = maxAttempts * LinkQualityTable::ETX_ONE;
+        }
+
+        LOG_DEBUG("Packets per slot: " << (int)packets_per_slot << " ETX: " << etx);
+        value_t error = SchedulingControl<Arithmetic>::tpsError(data.avgIn, etx, packets_per_slot, LinkQualityTable::ETX_ONE, slots);
+        LOG_DEBUG("TPS error: " << FLOAT_OUTPUT(Arithmetic::toFloat(error)));
         LOG_DEBUG("TPS slots: " << (int)slots);
 
-        int8_t change = 0;
-        if(useHysteresis) {
-            if(error > 0) {
-                change = ceil(error);
-            } else if(error < -2) {
-                change = ceil(error) + 1;
-            }
-        } else {
-            change = ceil(error);
+        int8_t change = SchedulingControl<Arithmetic>::tpsChange(error, useHysteresis);
+
+        if(data.deadlineMissesLastMultisuperframe > 0 && change < 1) {
+            /* '-> the link keeps missing deadlines, request an additional slot */
+            change = 1;
         }
 
         data.slotTarget = slots + change;
@@ -146,12 +162,21 @@ void TPS::multisuperframeEvent() {
 
         LOG_DEBUG("control"
                   << ",0x" << HEXOUT << this->dsmeAdaptionLayer.getDSME().getMAC_PIB().macShortAddress << ",0x" << data.address << "," << DECOUT
-                  << data.messagesInLastMultisuperframe << "," << data.messagesOutLastMultisuperframe << "," << FLOAT_OUTPUT(data.avgIn) << ","
+                  << data.messagesInLastMultisuperframe << "," << data.messagesOutLastMultisuperframe << "," << FLOAT_OUTPUT(Arithmetic::toFloat(data.avgIn)) << ","
                   << (uint16_t)slots << "," << data.slotTarget << "," << data.multisuperframesSinceLastPacket);
 
         data.messagesInLastMultisuperframe = 0;
         data.messagesOutLastMultisuperframe = 0;
+        data.deadlineMissesLastMultisuperframe = 0;
+
+        this->updatePriority(data);
     }
 }
 
+template struct TPSTxDataImpl<FloatArithmetic>;
+template class TPSImpl<FloatArithmetic>;
+
+template struct TPSTxDataImpl<FixedPointArithmetic<SCHEDULING_FRACTIONAL_BITS>>;
+template class TPSImpl<FixedPointArithmetic<SCHEDULING_FRACTIONAL_BITS>>;
+
 } /* namespace dsme */
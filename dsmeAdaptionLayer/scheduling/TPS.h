@@ -49,16 +49,24 @@ namespace dsme {
 
 class DSMEAdaptionLayer;
 
-struct TPSTxData : GTSSchedulingData {
-    TPSTxData();
+template <typename Arithmetic>
+struct TPSTxDataImpl : GTSSchedulingData {
+    TPSTxDataImpl();
 
-    float avgIn; // TODO no float!
+    typename Arithmetic::value_t avgIn;
     uint16_t multisuperframesSinceLastPacket;
 };
 
-class TPS : public GTSSchedulingImpl<TPSTxData, GTSRxData> {
+/*
+ * The Arithmetic selects between the float reference (TPS) and the fixed-point variant (FixedPointTPS),
+ * both are explicitly instantiated in TPS.cc.
+ */
+template <typename Arithmetic>
+class TPSImpl : public GTSSchedulingImpl<TPSTxDataImpl<Arithmetic>, GTSRxData, Arithmetic> {
 public:
-    TPS(DSMEAdaptionLayer& dsmeAdaptionLayer) : GTSSchedulingImpl(dsmeAdaptionLayer), alpha(0) {
+    typedef typename Arithmetic::value_t value_t;
+
+    TPSImpl(DSMEAdaptionLayer& dsmeAdaptionLayer) : GTSSchedulingImpl<TPSTxDataImpl<Arithmetic>, GTSRxData, Arithmetic>(dsmeAdaptionLayer), alpha(0) {
     }
 
     virtual void multisuperframeEvent();
@@ -69,12 +77,18 @@ public:
     void setUseMultiplePacketsPerGTS(bool useMultiplePackets);
 
 private:
-    float alpha{0}; // TODO no float
+    int32_t alpha; // in units of SchedulingControl::ALPHA_DENOMINATOR
     uint16_t minFreshness{0xFFFF};
     bool useHysteresis{true};
     bool useMultiplePacketsPerGTS{true};
 };
 
+typedef TPSTxDataImpl<FloatArithmetic> TPSTxData;
+typedef TPSImpl<FloatArithmetic> TPS;
+
+typedef TPSTxDataImpl<FixedPointArithmetic<SCHEDULING_FRACTIONAL_BITS>> FixedPointTPSTxData;
+typedef TPSImpl<FixedPointArithmetic<SCHEDULING_FRACTIONAL_BITS>> FixedPointTPS;
+
 } /* namespace dsme */
 
 #endif /* TPS_H_ */
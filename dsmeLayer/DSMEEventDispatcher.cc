@@ -92,12 +92,19 @@ void DSMEEventDispatcher::fireIFSTimer(int32_t lateness) {
     this->dsme.getMessageDispatcher().handleIFSEvent(lateness);
 }
 
+void DSMEEventDispatcher::fireRxOnTimer(int32_t lateness) {
+    this->dsme.getPlatform().turnTransceiverOn();
+}
+
 /********** Setup Methods **********/
 
 uint32_t DSMEEventDispatcher::setupSlotTimer(uint32_t lastSlotTime, uint8_t skippedSlots) {
     uint32_t symbols_per_slot = dsme.getMAC_PIB().helper.getSymbolsPerSlot();
     uint32_t next_slot_time = lastSlotTime + (1 + skippedSlots) * symbols_per_slot;
 
+    /* follow the clock of the SYNC parent between its beacons */
+    next_slot_time += dsme.getBeaconManager().compensateDrift((1 + skippedSlots) * symbols_per_slot);
+
     DSME_ATOMIC_BLOCK {
         if(next_slot_time - PRE_EVENT_SHIFT <= NOW + 1) {
             next_slot_time += symbols_per_slot;
@@ -144,6 +151,14 @@ void DSMEEventDispatcher::setupIFSTimer(bool LIFS) {
     return;
 }
 
+void DSMEEventDispatcher::setupRxOnTimer(uint32_t absSymCnt) {
+    DSME_ATOMIC_BLOCK {
+        DSMETimerMultiplexer::_startTimer<RX_ON_TIMER>(absSymCnt, &DSMEEventDispatcher::fireRxOnTimer);
+        DSMETimerMultiplexer::_scheduleTimer();
+    }
+    return;
+}
+
 void DSMEEventDispatcher::stopIFSTimer() {
     DSME_ATOMIC_BLOCK {
         DSMETimerMultiplexer::_stopTimer<IFS_TIMER>();
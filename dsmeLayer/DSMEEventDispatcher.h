@@ -58,8 +58,9 @@ enum EventTimers {
     NEXT_SLOT,
     CSMA_TIMER,
     ACK_TIMER,
-    IFS_TIMER,  /* IFS after dataframe transmission */
-    TIMER_COUNT /* always last element */
+    IFS_TIMER,   /* IFS after dataframe transmission */
+    RX_ON_TIMER, /* delayed start of a reception, see DSMELayer::startReceptionInNextSlot */
+    TIMER_COUNT  /* always last element */
 };
 
 class DSMEEventDispatcher;
@@ -85,6 +86,8 @@ public:
     void setupIFSTimer(bool LIFS);
     void stopIFSTimer();
 
+    void setupRxOnTimer(uint32_t absSymCnt);
+
 private:
     DSMELayer& dsme;
 
@@ -93,6 +96,7 @@ private:
     void fireCSMATimer(int32_t lateness);
     void fireACKTimer(int32_t lateness);
     void fireIFSTimer(int32_t lateness);
+    void fireRxOnTimer(int32_t lateness);
 
     ReadonlyTimerAbstraction<IDSMEPlatform> NOW;
     WriteonlyTimerAbstraction<IDSMEPlatform> TIMER;
@@ -63,10 +63,12 @@ DSMELayer::DSMELayer()
       eventDispatcher(*this),
 
       ackLayer(*this),
+      capClock(*this),
       capLayer(*this),
       associationManager(*this),
       beaconManager(*this),
       gtsManager(*this),
+      centralScheduler(*this),
       messageDispatcher(*this),
 
       currentSlot(0),
@@ -140,6 +142,7 @@ void DSMELayer::doReset() {
         this->beaconManager.reset();
         this->associationManager.reset();
         this->gtsManager.reset();
+        this->centralScheduler.reset();
         this->messageDispatcher.reset();
 
         this->capLayer.reset();
@@ -187,6 +190,16 @@ void DSMELayer::preSlotEvent(void) {
     messageDispatcher.handlePreSlotEvent(nextSlot, nextSuperframe, nextMultiSuperframe);
 }
 
+void DSMELayer::startReceptionInNextSlot(uint16_t guardTime) {
+    /* the transceiver needs up to aTurnaroundTime to be ready for reception */
+    uint32_t rxOnTime = this->nextSlotTime - guardTime - aTurnaroundTime;
+    if(guardTime + aTurnaroundTime >= PRE_EVENT_SHIFT || (int32_t)(rxOnTime - platform->getSymbolCounter()) <= 1) {
+        platform->turnTransceiverOn();
+    } else {
+        eventDispatcher.setupRxOnTimer(rxOnTime);
+    }
+}
+
 void DSMELayer::slotEvent(int32_t lateness) {
     if(resetPending) {
         doReset();
@@ -255,34 +268,17 @@ void DSMELayer::handleStartOfCFP() {
 
     this->capLayer.handleStartOfCFP();
     this->gtsManager.handleStartOfCFP(this->currentSuperframe);
+    this->centralScheduler.handleStartOfCFP(this->currentSuperframe);
     this->associationManager.handleStartOfCFP(this->currentSuperframe);
     this->beaconManager.handleStartOfCFP(this->currentSuperframe, this->currentMultiSuperframe);
 }
 
 uint32_t DSMELayer::getSymbolsSinceCapFrameStart(uint32_t time) {
-    uint32_t symbolsSinceLastBeaconInterval = time - this->beaconManager.getLastKnownBeaconIntervalStart();
-
-    if(this->mac_pib->macCapReduction) {
-        uint32_t symbolsPerMultiSuperframe = aNumSuperframeSlots * (uint32_t)aBaseSlotDuration * (1 << (uint32_t) this->mac_pib->macMultiSuperframeOrder);
-        uint32_t symbolsSinceLastMultiSuperframeStart = symbolsSinceLastBeaconInterval % symbolsPerMultiSuperframe;
-        return symbolsSinceLastMultiSuperframeStart;
-    } else {
-        uint32_t symbolsPerSuperframe = aNumSuperframeSlots * (uint32_t)aBaseSlotDuration * (1 << (uint32_t) this->mac_pib->macSuperframeOrder);
-        uint32_t symbolsSinceLastSuperframeStart = symbolsSinceLastBeaconInterval % symbolsPerSuperframe;
-        return symbolsSinceLastSuperframeStart;
-    }
+    return this->capClock.getSymbolsSinceCapFrameStart(time);
 }
 
 bool DSMELayer::isWithinCAP(uint32_t time, uint16_t duration) {
-    uint32_t symbolsPerSlot = getMAC_PIB().helper.getSymbolsPerSlot();
-
-    uint32_t symbolsSinceCapFrameStart = getSymbolsSinceCapFrameStart(time);
-
-    uint32_t capStart = symbolsPerSlot; // after beacon slot
-    uint32_t capEnd = symbolsPerSlot * (getMAC_PIB().helper.getFinalCAPSlot(0) + 1) - PRE_EVENT_SHIFT;  //TODO: IS THIS CORRECT????
-
-    return (symbolsSinceCapFrameStart >= capStart)              // after beacon slot
-           && (symbolsSinceCapFrameStart + duration <= capEnd); // before pre-event of first GTS
+    return this->capClock.isWithinCAP(time, duration);
 }
 
 bool DSMELayer::isWithinTimeSlot(uint32_t now, uint16_t duration) {
@@ -53,7 +53,9 @@
 #include "./ackLayer/AckLayer.h"
 #include "./associationManager/AssociationManager.h"
 #include "./beaconManager/BeaconManager.h"
+#include "./capLayer/CAPClock.h"
 #include "./capLayer/CAPLayer.h"
+#include "./gtsManager/CentralScheduler.h"
 #include "./gtsManager/GTSManager.h"
 #include "./messageDispatcher/MessageDispatcher.h"
 
@@ -138,6 +140,10 @@ public:
         return gtsManager;
     }
 
+    CentralScheduler& getCentralScheduler() {
+        return centralScheduler;
+    }
+
     AssociationManager& getAssociationManager() {
         return this->associationManager;
     }
@@ -162,6 +168,10 @@ public:
         return capLayer;
     }
 
+    const CAPClock& getCapClock() const {
+        return capClock;
+    }
+
     IDSMEPlatform& getPlatform() {
         return *platform;
     }
@@ -177,6 +187,12 @@ public:
     void preSlotEvent(void);
     void slotEvent(int32_t lateness);
 
+    /** Turns the transceiver on for a reception in the next slot.
+     *\param guardTime Time in symbols the reception has to start before the next slot, the transceiver
+     *                  is turned on right away if this does not fit into the remaining PRE_EVENT_SHIFT
+     */
+    void startReceptionInNextSlot(uint16_t guardTime);
+
     uint32_t getSymbolsSinceCapFrameStart(uint32_t time);
 
     /** Checks if \p time + \p duration is withing a CAP.
@@ -218,11 +234,13 @@ protected:
 
     /* COMPONENTS OF THE DSMELAYER ----------------------------------------> */
     AckLayer ackLayer;
+    CAPClock capClock;
     CAPLayer capLayer;
 
     AssociationManager associationManager;
     BeaconManager beaconManager;
     GTSManager gtsManager;
+    CentralScheduler centralScheduler;
     MessageDispatcher messageDispatcher;
     /* <---------------------------------------- COMPONENTS OF THE DSMELAYER */
 
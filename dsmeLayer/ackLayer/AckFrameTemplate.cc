@@ -0,0 +1,86 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "./AckFrameTemplate.h"
+
+#include "../../../dsme_platform.h"
+#include "../messages/IEEE802154eMACHeader.h"
+#include "../messages/TimeCorrectionIE.h"
+
+namespace dsme {
+
+constexpr uint8_t AckFrameTemplate::IMM_ACK_LENGTH;
+constexpr uint8_t AckFrameTemplate::ENHANCED_ACK_LENGTH;
+
+AckFrameTemplate::AckFrameTemplate() : immAck{}, enhancedAck{} {
+    /* use the generic serialization once, so the templates are identical to the ACKs built from a message */
+    IEEE802154eMACHeader header;
+    header.setFrameType(IEEE802154eMACHeader::ACKNOWLEDGEMENT);
+    header.setSequenceNumber(0);
+
+    uint8_t* buffer = this->immAck;
+    header.serializeTo(buffer);
+    DSME_ASSERT(buffer == this->immAck + IMM_ACK_LENGTH);
+
+    header.setIEListPresent(true);
+    buffer = this->enhancedAck;
+    header.serializeTo(buffer);
+    DSME_ASSERT(buffer == this->enhancedAck + IMM_ACK_LENGTH);
+
+    *(buffer++) = TimeCorrectionIE::DESCRIPTOR & 0xFF;
+    *(buffer++) = TimeCorrectionIE::DESCRIPTOR >> 8;
+}
+
+const uint8_t* AckFrameTemplate::getImmAck(uint8_t seqNum) {
+    this->immAck[SEQUENCE_NUMBER_OFFSET] = seqNum;
+    return this->immAck;
+}
+
+const uint8_t* AckFrameTemplate::getEnhancedAck(uint8_t seqNum, int16_t timeCorrection, bool nack) {
+    uint16_t content = TimeCorrectionIE::encode(timeCorrection, nack);
+    this->enhancedAck[SEQUENCE_NUMBER_OFFSET] = seqNum;
+    this->enhancedAck[TIME_CORRECTION_OFFSET] = content & 0xFF;
+    this->enhancedAck[TIME_CORRECTION_OFFSET + 1] = content >> 8;
+    return this->enhancedAck;
+}
+
+} /* namespace dsme */
@@ -0,0 +1,87 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef ACKFRAMETEMPLATE_H_
+#define ACKFRAMETEMPLATE_H_
+
+#include "../../helper/Integers.h"
+
+namespace dsme {
+
+/**
+ * Pre-serialized acknowledgement frames (without FCS).
+ * Sending an ACK only requires to patch the sequence number and, for the Enhanced-ACK, the content of the Time Correction IE,
+ * so the time between reception and the transmission of the ACK does not depend on the CPU load.
+ */
+class AckFrameTemplate {
+public:
+    /* frame control and sequence number */
+    static constexpr uint8_t IMM_ACK_LENGTH = 3;
+
+    /* additionally the descriptor and the content of the Time Correction IE */
+    static constexpr uint8_t ENHANCED_ACK_LENGTH = IMM_ACK_LENGTH + 4;
+
+    AckFrameTemplate();
+
+    /**
+     * Immediate ACK as generated by the generic header serialization
+     */
+    const uint8_t* getImmAck(uint8_t seqNum);
+
+    /**
+     * Enhanced-ACK with a Time Correction IE
+     * \param timeCorrection Time correction in symbols, see TimeCorrectionIE
+     * \param nack Set if the frame was received but not accepted
+     */
+    const uint8_t* getEnhancedAck(uint8_t seqNum, int16_t timeCorrection, bool nack);
+
+private:
+    static constexpr uint8_t SEQUENCE_NUMBER_OFFSET = 2;
+    static constexpr uint8_t TIME_CORRECTION_OFFSET = IMM_ACK_LENGTH + 2;
+
+    uint8_t immAck[IMM_ACK_LENGTH];
+    uint8_t enhancedAck[ENHANCED_ACK_LENGTH];
+};
+
+} /* namespace dsme */
+
+#endif /* ACKFRAMETEMPLATE_H_ */
@@ -51,9 +51,12 @@
 #include "../../mac_services/DSME_Common.h"
 #include "../../mac_services/dataStructures/IEEE802154MacAddress.h"
 #include "../../mac_services/pib/MAC_PIB.h"
+#include "../../mac_services/pib/PHY_PIB.h"
+#include "../../mac_services/pib/dsme_phy_constants.h"
 #include "../DSMEEventDispatcher.h"
 #include "../DSMELayer.h"
 #include "../messages/IEEE802154eMACHeader.h"
+#include "../messages/TimeCorrectionIE.h"
 
 namespace dsme {
 
@@ -62,6 +65,15 @@ AckLayer::AckLayer(DSMELayer& dsme)
 }
 
 void AckLayer::reset() {
+    discardNextSendingCopy();
+
+    DSME_ATOMIC_BLOCK {
+        while(!this->receiveQueue.empty()) {
+            this->dsme.getPlatform().releaseMessage(this->receiveQueue.front());
+            this->receiveQueue.pop();
+        }
+    }
+
     bool dispatchSuccessful = dispatch(AckEvent::RESET);
     DSME_ASSERT(dispatchSuccessful);
 }
@@ -102,6 +114,35 @@ void AckLayer::abortPreparedTransmission() {
     }
 }
 
+bool AckLayer::prepareNextSendingCopy(IDSMEMessage* msg) {
+    if(this->nextMessage != nullptr || msg == this->pendingMessage) {
+        return false;
+    }
+
+    /* the sequence number has to be known for serialization, it is kept if the message is sent later on */
+    bool newSequenceNumber = msg->getHeader().hasSequenceNumber() && msg->getRetryCounter() == 0;
+    if(newSequenceNumber) {
+        msg->getHeader().setSequenceNumber(this->dsme.getMAC_PIB().macDsn++);
+    }
+
+    if(!dsme.getPlatform().prepareNextSendingCopy(msg)) {
+        if(newSequenceNumber) {
+            this->dsme.getMAC_PIB().macDsn--;
+        }
+        return false;
+    }
+
+    this->nextMessage = msg;
+    return true;
+}
+
+void AckLayer::discardNextSendingCopy(IDSMEMessage* msg) {
+    if(this->nextMessage != nullptr && (msg == nullptr || msg == this->nextMessage)) {
+        this->nextMessage = nullptr;
+        dsme.getPlatform().discardNextSendingCopy();
+    }
+}
+
 void AckLayer::receive(IDSMEMessage* msg) {
     IEEE802154eMACHeader& header = msg->getHeader();
 
@@ -119,9 +160,24 @@ void AckLayer::receive(IDSMEMessage* msg) {
     if(header.getFrameType() == IEEE802154eMACHeader::ACKNOWLEDGEMENT) {
         LOG_DEBUG("ACK_RECEIVED with seq num " << (uint16_t)header.getSequenceNumber());
         uint8_t seqNum = header.getSequenceNumber();
+
+        /* Enhanced-ACK */
+        bool hasTimeCorrection = false;
+        TimeCorrectionIE timeCorrectionIE;
+        if(header.isIEListPresent() && msg->hasPayload()) {
+            msg->decapsulateTo(&timeCorrectionIE);
+            hasTimeCorrection = timeCorrectionIE.isValid();
+        }
+
         dsme.getPlatform().releaseMessage(msg);
         DSME_ASSERT(!isDispatchBusy());
-        bool dispatchSuccessful = dispatch(AckEvent::ACK_RECEIVED, seqNum);
+        bool dispatchSuccessful;
+        if(hasTimeCorrection) {
+            int16_t timeCorrection = timeCorrectionIE.getTimeCorrection();
+            dispatchSuccessful = dispatch(AckEvent::ACK_RECEIVED, seqNum, timeCorrection);
+        } else {
+            dispatchSuccessful = dispatch(AckEvent::ACK_RECEIVED, seqNum);
+        }
         DSME_ASSERT(dispatchSuccessful);
         return;
     }
@@ -146,12 +202,16 @@ void AckLayer::receive(IDSMEMessage* msg) {
         return;
     }
 
-    /* also throw away the packet if the FSM is busy */
+    /* keep the packet for later if the FSM is busy, throw it away only if there is no space left */
     DSME_ATOMIC_BLOCK {
         if(busy) {
-            LOG_DEBUG("Throwing away packet, ACKLayer was busy.");
-            this->dsme.getPlatform().releaseMessage(msg);
-            // DSME_SIM_ASSERT(false);
+            if(this->receiveQueue.full()) {
+                LOG_DEBUG("Throwing away packet, ACKLayer was busy.");
+                this->dsme.getPlatform().releaseMessage(msg);
+                // DSME_SIM_ASSERT(false);
+            } else {
+                this->receiveQueue.push(msg);
+            }
             return;
         } else {
             busy = true;
@@ -183,6 +243,34 @@ bool AckLayer::ifMsgPending(){
 return pending;
 }
 
+bool AckLayer::isAckInTime(IDSMEMessage* msg) {
+    /* the sender waits for the duration of an ACK wait after the end of its transmission */
+    uint32_t endOfFrame = msg->getStartOfFrameDelimiterSymbolCounter() + msg->getMPDUSymbols();
+    uint32_t ackSymbols = aTurnaroundTime + dsme.getPHY_PIB().phySHRDuration + 6 * dsme.getPHY_PIB().phySymbolsPerOctet;
+    return dsme.getPlatform().getSymbolCounter() - endOfFrame + ackSymbols <= dsme.getMAC_PIB().helper.getAckWaitDuration();
+}
+
+void AckLayer::handleQueuedReception() {
+    IDSMEMessage* msg = nullptr;
+    DSME_ATOMIC_BLOCK {
+        if(this->receiveQueue.empty()) {
+            this->busy = false;
+        } else {
+            msg = this->receiveQueue.front();
+            this->receiveQueue.pop();
+        }
+    }
+
+    if(msg == nullptr) {
+        return;
+    }
+
+    /* busy is still set, so the request is handled right after the current event */
+    this->pendingMessage = msg;
+    bool dispatchSuccessful = dispatch(AckEvent::RECEIVE_REQUEST);
+    DSME_ASSERT(dispatchSuccessful);
+}
+
 void AckLayer::sendDone(bool success) {
     DSME_ASSERT(!isDispatchBusy());
     bool dispatchSuccessful = dispatch(AckEvent::SEND_DONE, success);
@@ -206,17 +294,21 @@ fsmReturnStatus AckLayer::catchAll(AckEvent& event) {
 fsmReturnStatus AckLayer::stateIdle(AckEvent& event) {
     switch(event.signal) {
         case AckEvent::ENTRY_SIGNAL:
-            DSME_ATOMIC_BLOCK {
-                this->busy = false;
-            }
+            handleQueuedReception();
             return FSM_HANDLED;
 
         case AckEvent::RESET:
             return FSM_HANDLED;
 
         case AckEvent::PREPARE_SEND_REQUEST: {
+            /* preparing a message always consumes or discards the second transmit buffer of the radio */
+            bool alreadySerialized = (pendingMessage == nextMessage);
+            nextMessage = nullptr;
+
             if(pendingMessage->getHeader().hasSequenceNumber()) {
-                if(pendingMessage->getRetryCounter() == 0) {
+                if(alreadySerialized) {
+                    /* sequence number was assigned in prepareNextSendingCopy */
+                } else if(pendingMessage->getRetryCounter() == 0) {
                     pendingMessage->getHeader().setSequenceNumber(this->dsme.getMAC_PIB().macDsn++);
                 } else {
                     /* message is a retransmit, keeps sequence number from previous try */
@@ -228,9 +320,7 @@ fsmReturnStatus AckLayer::stateIdle(AckEvent& event) {
             } else {
                 /* '-> currently busy (e.g. recent reception) */
                 signalResult(SEND_FAILED);
-                DSME_ATOMIC_BLOCK {
-                    this->busy = false;
-                }
+                handleQueuedReception();
                 return FSM_HANDLED;
             }
         }
@@ -239,31 +329,64 @@ fsmReturnStatus AckLayer::stateIdle(AckEvent& event) {
             if(!dsme.getPlatform().isReceptionFromAckLayerPossible()) {
                 dsme.getPlatform().releaseMessage(pendingMessage);
                 pendingMessage = nullptr;
-                DSME_ATOMIC_BLOCK {
-                    this->busy = false;
-                }
+                handleQueuedReception();
                 return FSM_HANDLED;
             }
 
             // according to 5.2.1.1.4, the ACK shall be sent anyway even with broadcast address, but this can not work for GTS replies (where the AR bit has to
             // be set 5.3.11.5.2)
             if(pendingMessage->getHeader().isAckRequested() && !pendingMessage->getHeader().getDestAddr().isBroadcast()) {
+                if(!isAckInTime(pendingMessage)) {
+                    /* '-> the frame was queued too long, the sender will retransmit it, so handling it would duplicate it */
+                    LOG_DEBUG("Throwing away packet, too late for ACK.");
+                    dsme.getPlatform().releaseMessage(pendingMessage);
+                    pendingMessage = nullptr;
+                    handleQueuedReception();
+                    return FSM_HANDLED;
+                }
+
                 LOG_DEBUG("sending ACK");
 
-                // keep the received message and set up the acknowledgement as new pending message
                 IDSMEMessage* receivedMessage = pendingMessage;
+                uint8_t seqNum = receivedMessage->getHeader().getSequenceNumber();
+
+                /* the sender is informed about its clock offset if the frame was sent at a slot boundary */
+                int16_t timeCorrection = 0;
+                bool enhancedAck = dsme.getBeaconManager().getTimeCorrection(receivedMessage, timeCorrection);
+
+                /* fast path: the platform sends the patched template, no message has to be built */
+                const uint8_t* ackFrame;
+                uint8_t ackLength;
+                if(enhancedAck) {
+                    ackFrame = ackTemplate.getEnhancedAck(seqNum, timeCorrection, false);
+                    ackLength = AckFrameTemplate::ENHANCED_ACK_LENGTH;
+                } else {
+                    ackFrame = ackTemplate.getImmAck(seqNum);
+                    ackLength = AckFrameTemplate::IMM_ACK_LENGTH;
+                }
+                if(dsme.getPlatform().sendDelayedAckFromBuffer(ackFrame, ackLength, receivedMessage, internalDoneCallback)) {
+                    pendingMessage = nullptr;
+                    dsme.getPlatform().handleReceivedMessageFromAckLayer(receivedMessage);
+                    return transition(&AckLayer::stateTxAck);
+                }
+
+                // keep the received message and set up the acknowledgement as new pending message
                 pendingMessage = dsme.getPlatform().getEmptyMessage();
                 if(pendingMessage == nullptr) {
                     DSME_ASSERT(false);
-                    DSME_ATOMIC_BLOCK {
-                        this->busy = false;
-                    }
+                    handleQueuedReception();
                     return FSM_HANDLED;
                 }
 
                 IEEE802154eMACHeader& ackHeader = pendingMessage->getHeader();
                 ackHeader.setFrameType(IEEE802154eMACHeader::ACKNOWLEDGEMENT);
-                ackHeader.setSequenceNumber(receivedMessage->getHeader().getSequenceNumber());
+                ackHeader.setSequenceNumber(seqNum);
+
+                if(enhancedAck) {
+                    TimeCorrectionIE timeCorrectionIE(timeCorrection, false);
+                    timeCorrectionIE.prependTo(pendingMessage);
+                    ackHeader.setIEListPresent(true);
+                }
 
                 ackHeader.setDstAddr(receivedMessage->getHeader().getSrcAddr()); // TODO remove, this is only for the sequence diagram
 
@@ -280,17 +403,13 @@ fsmReturnStatus AckLayer::stateIdle(AckEvent& event) {
 
                     dsme.getPlatform().releaseMessage(pendingMessage);
                     pendingMessage = nullptr;
-                    DSME_ATOMIC_BLOCK {
-                        this->busy = false;
-                    }
+                    handleQueuedReception();
                     return FSM_HANDLED;
                 }
             } else {
                 dsme.getPlatform().handleReceivedMessageFromAckLayer(pendingMessage);
                 pendingMessage = nullptr; // owned by upper layer now
-                DSME_ATOMIC_BLOCK {
-                    this->busy = false;
-                }
+                handleQueuedReception();
                 return FSM_HANDLED;
             }
 
@@ -361,6 +480,9 @@ fsmReturnStatus AckLayer::stateWaitForAck(AckEvent& event) {
         case AckEvent::ACK_RECEIVED:
             if(event.seqNum == pendingMessage->getHeader().getSequenceNumber()) {
                 dsme.getEventDispatcher().stopACKTimer();
+                if(event.hasTimeCorrection) {
+                    dsme.getBeaconManager().handleTimeCorrection(pendingMessage->getHeader().getDestAddr(), event.timeCorrection);
+                }
                 signalResult(ACK_SUCCESSFUL);
                 return transition(&AckLayer::stateIdle);
             } else {
@@ -384,8 +506,11 @@ fsmReturnStatus AckLayer::stateWaitForAck(AckEvent& event) {
 fsmReturnStatus AckLayer::stateTxAck(AckEvent& event) {
     switch(event.signal) {
         case AckEvent::SEND_DONE:
-            dsme.getPlatform().releaseMessage(pendingMessage);
-            pendingMessage = nullptr;
+            // no message is held if the ACK was sent from the template
+            if(pendingMessage) {
+                dsme.getPlatform().releaseMessage(pendingMessage);
+                pendingMessage = nullptr;
+            }
             return transition(&AckLayer::stateIdle);
 
         case AckEvent::RESET:
@@ -45,9 +45,18 @@
 
 #include "../../helper/DSMEBufferedFSM.h"
 #include "../../helper/DSMEDelegate.h"
+#include "../../helper/DSMEQueue.h"
+#include "./AckFrameTemplate.h"
+
+#ifndef DSME_ACK_RECEIVE_QUEUE_SIZE
+#define DSME_ACK_RECEIVE_QUEUE_SIZE 4
+#endif
 
 namespace dsme {
 
+/* number of frames that can be held while the AckLayer is busy with a transmission */
+constexpr uint8_t ACK_RECEIVE_QUEUE_SIZE = DSME_ACK_RECEIVE_QUEUE_SIZE;
+
 class IDSMEMessage;
 class DSMELayer;
 
@@ -65,6 +74,14 @@ public:
     void fill(uint16_t signal, uint8_t seqNum) {
         this->signal = signal;
         this->seqNum = seqNum;
+        this->hasTimeCorrection = false;
+    }
+
+    void fill(uint16_t signal, uint8_t seqNum, int16_t timeCorrection) {
+        this->signal = signal;
+        this->seqNum = seqNum;
+        this->hasTimeCorrection = true;
+        this->timeCorrection = timeCorrection;
     }
 
     enum : uint8_t {
@@ -80,6 +97,9 @@ public:
 
     bool success;   // only valid for SEND_DONE
     uint8_t seqNum; // only valid for ACK_RECEIVED
+
+    bool hasTimeCorrection; // only valid for ACK_RECEIVED
+    int16_t timeCorrection; // only valid for ACK_RECEIVED with hasTimeCorrection
 };
 
 class AckLayer : private DSMEBufferedFSM<AckLayer, AckEvent, 2> {
@@ -98,6 +118,19 @@ public:
     void sendNowIfPending();
     void abortPreparedTransmission();
 
+    /**
+     * Serializes the message that is expected to follow the current transmission into the
+     * second transmit buffer of the radio, so the next prepareSendingCopy() is cheap.
+     * @return true, if the radio accepted the message
+     */
+    bool prepareNextSendingCopy(IDSMEMessage* msg);
+
+    /**
+     * Discards the message prepared via prepareNextSendingCopy() if it matches (or any message if nullptr).
+     * This has to be called before such a message is released.
+     */
+    void discardNextSendingCopy(IDSMEMessage* msg = nullptr);
+
     void sendAdditionalAck(uint8_t seqNum);
     void receive(IDSMEMessage* msg);
     void dispatchTimer();
@@ -105,6 +138,8 @@ public:
 
 private:
     void sendDone(bool success);
+    bool isAckInTime(IDSMEMessage* msg);
+    void handleQueuedReception();
     fsmReturnStatus stateIdle(AckEvent& event);
     fsmReturnStatus statePreparingTx(AckEvent& event);
     fsmReturnStatus stateTx(AckEvent& event);
@@ -123,6 +158,21 @@ private:
 
     IDSMEMessage* pendingMessage{nullptr};
 
+    /*
+     * Message that is held in the second transmit buffer of the radio
+     */
+    IDSMEMessage* nextMessage{nullptr};
+
+    /*
+     * Frames received while the layer was busy, they are handled as soon as it gets idle again
+     */
+    DSMEQueue<IDSMEMessage*, ACK_RECEIVE_QUEUE_SIZE> receiveQueue;
+
+    /*
+     * Pre-serialized ACK frames for the fast path of the platform
+     */
+    AckFrameTemplate ackTemplate;
+
     done_callback_t externalDoneCallback;
 
     const Delegate<void(bool)> internalDoneCallback;
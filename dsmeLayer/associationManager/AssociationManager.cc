@@ -166,7 +166,7 @@ void AssociationManager::sendAssociationReply(DSMEAssociationResponseCmd& respon
 
     msg->getHeader().setFrameType(IEEE802154eMACHeader::FrameType::COMMAND);
 
-    if(!dsme.getMessageDispatcher().sendInCAP(msg)) {
+    if(!dsme.getMessageDispatcher().sendInCAP(msg, CAPClass::REPLY)) {
         // TODO
         dsme.getPlatform().releaseMessage(msg);
     }
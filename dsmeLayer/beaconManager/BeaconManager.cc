@@ -77,6 +77,11 @@ BeaconManager::BeaconManager(DSMELayer& dsme)
 
       numBeaconCollision(0),
       missedBeacons(0),
+      timeCorrectionReferenceValid(false),
+      timeCorrectionPending(false),
+      pendingTimeCorrection(0),
+      synchronizedByAck(false),
+      driftEstimatorParent(IEEE802154MacAddress::NO_SHORT_ADDRESS),
       doneCallback(DELEGATE(&BeaconManager::sendDone, *this)),
 
       currentScanChannel(0),
@@ -129,6 +134,10 @@ void BeaconManager::reset() {
     isBeaconAllocated = false;
     isBeaconAllocationSent = false;
     missedBeacons = 0;
+    timeCorrectionReferenceValid = false;
+    timeCorrectionPending = false;
+    synchronizedByAck = false;
+    driftEstimator.reset();
 
     if(dsme.getMAC_PIB().macIsPANCoord) {
         dsmePANDescriptor.getBeaconBitmap().setSDIndex(0);
@@ -145,14 +154,31 @@ void BeaconManager::reset() {
 void BeaconManager::preSuperframeEvent(uint16_t nextSuperframe, uint16_t nextMultiSuperframe, uint32_t startSlotTime) {
     uint16_t nextSDIndex = nextSuperframe + this->dsme.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe() * nextMultiSuperframe;
 
+    if(this->timeCorrectionPending) {
+        /* '-> shift the slot grid only between superframes, never within an ongoing GTS */
+        this->timeCorrectionPending = false;
+        LOG_DEBUG("Time correction of " << this->pendingTimeCorrection << " symbols by Enhanced-ACK");
+        this->lastKnownBeaconIntervalStart += this->pendingTimeCorrection;
+        this->missedBeacons = 0;
+        this->synchronizedByAck = true;
+    }
+
     if((this->isBeaconAllocated || this->dsme.getMAC_PIB().macIsPANCoord) && nextSDIndex == this->dsmePANDescriptor.getBeaconBitmap().getSDIndex()) {
         // This node will transmit a beacon
         this->dsme.getPlatform().turnTransceiverOn();
         this->dsme.getPlatform().setChannelNumber(this->dsme.getPHY_PIB().phyCurrentChannel);
         prepareEnhancedBeacon(startSlotTime);
+    } else if(nextSDIndex == this->dsme.getMAC_PIB().macSyncParentSdIndex && this->synchronizedByAck && !this->dsme.getMAC_PIB().macIsCoord) {
+        // The beacon of the SYNC-parent is not required, the synchronization was kept by Enhanced-ACKs
+        this->synchronizedByAck = false;
+        this->dsme.getPlatform().turnTransceiverOff();
     } else if((!dsme.getMAC_PIB().macAssociatedPANCoord) || nextSDIndex == this->dsme.getMAC_PIB().macSyncParentSdIndex) {
         // This node expects a beacon, only if not associated or a beacon from the SYNC-parent is expected
-        this->dsme.getPlatform().turnTransceiverOn();
+        if(dsme.getMAC_PIB().macAssociatedPANCoord) {
+            this->dsme.startReceptionInNextSlot(getRxGuardTime());
+        } else {
+            this->dsme.getPlatform().turnTransceiverOn();
+        }
         this->dsme.getPlatform().setChannelNumber(this->dsme.getPHY_PIB().phyCurrentChannel);
     } else {
         this->dsme.getPlatform().turnTransceiverOff();
@@ -315,6 +341,11 @@ bool BeaconManager::handleEnhancedBeacon(IDSMEMessage* msg, DSMEPANDescriptor& d
     /* Reset the number of missed beacons */
     this->missedBeacons = 0;
 
+    /* the beacon is the new reference, corrections measured against the previous one are obsolete */
+    this->timeCorrectionReferenceValid = true;
+    this->timeCorrectionPending = false;
+    this->synchronizedByAck = false;
+
     // TODO do this on lower layer to gain accuracy and include offset in calculation
     uint16_t lastHeardBeaconSDIndex = descr.getBeaconBitmap().getSDIndex();
 
@@ -324,6 +355,14 @@ bool BeaconManager::handleEnhancedBeacon(IDSMEMessage* msg, DSMEPANDescriptor& d
     lastKnownBeaconIntervalStart = msg->getStartOfFrameDelimiterSymbolCounter() -
                                    lastHeardBeaconSDIndex * aNumSuperframeSlots * dsme.getMAC_PIB().helper.getSymbolsPerSlot() - 8 - 2 - offset;
 
+    if(this->driftEstimatorParent != this->dsme.getMAC_PIB().macSyncParentShortAddress) {
+        this->driftEstimator.reset();
+        this->driftEstimatorParent = this->dsme.getMAC_PIB().macSyncParentShortAddress;
+    }
+    uint32_t beaconIntervalLength = dsme.getMAC_PIB().helper.getSymbolsPerSlot() * aNumSuperframeSlots *
+                                    dsme.getMAC_PIB().helper.getNumberSuperframesPerBeaconInterval();
+    this->driftEstimator.addSample(lastKnownBeaconIntervalStart, beaconIntervalLength);
+
     // Coordinator device request free beacon slots
     LOG_DEBUG("Checking if beacon has to be allocated: "
               << "isCoordinator:" << dsme.getMAC_PIB().macIsCoord << ", isBeaconAllocated:" << isBeaconAllocated
@@ -346,6 +385,63 @@ bool BeaconManager::handleEnhancedBeacon(IDSMEMessage* msg, DSMEPANDescriptor& d
     return false;
 }
 
+bool BeaconManager::getTimeCorrection(IDSMEMessage* msg, int16_t& timeCorrection) {
+    if(!this->dsme.getMAC_PIB().macIsCoord) {
+        return false;
+    }
+
+    /* position of the frame start relative to the nearest slot boundary */
+    uint32_t symbolsPerSlot = this->dsme.getMAC_PIB().helper.getSymbolsPerSlot();
+    uint32_t frameStart = msg->getStartOfFrameDelimiterSymbolCounter() - this->dsme.getPHY_PIB().phySHRDuration;
+    uint32_t symbolsSinceBeaconInterval = frameStart - this->lastKnownBeaconIntervalStart + symbolsPerSlot / 2;
+    int32_t offset = (int32_t)(symbolsSinceBeaconInterval % symbolsPerSlot) - (int32_t)(symbolsPerSlot / 2);
+
+    if(offset > DSME_TIME_CORRECTION_WINDOW || offset < -DSME_TIME_CORRECTION_WINDOW) {
+        return false;
+    }
+
+    /* frames in the CAP are sent at random times */
+    uint32_t slots = symbolsSinceBeaconInterval / symbolsPerSlot;
+    uint8_t slot = slots % aNumSuperframeSlots;
+    uint8_t superframe = (slots / aNumSuperframeSlots) % this->dsme.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe();
+    if(slot <= this->dsme.getMAC_PIB().helper.getFinalCAPSlot(superframe)) {
+        return false;
+    }
+
+    timeCorrection = -offset;
+    return true;
+}
+
+void BeaconManager::handleTimeCorrection(const IEEE802154MacAddress& sender, int16_t timeCorrection) {
+    if(!this->dsme.isTrackingBeacons() || sender.getShortAddress() != this->dsme.getMAC_PIB().macSyncParentShortAddress) {
+        return;
+    }
+
+    if(!this->timeCorrectionReferenceValid) {
+        /* '-> the slot grid was not yet derived from a beacon of the SYNC parent */
+        return;
+    }
+
+    /* the correction is the offset of the whole slot grid, so a later one replaces an earlier one that was not applied yet */
+    this->pendingTimeCorrection = timeCorrection;
+    this->timeCorrectionPending = true;
+}
+
+int32_t BeaconManager::compensateDrift(uint32_t elapsedSymbols) {
+    if(!this->dsme.isTrackingBeacons() || this->dsme.getMAC_PIB().macIsPANCoord) {
+        return 0;
+    }
+
+    int32_t compensation = this->driftEstimator.getCompensation(elapsedSymbols);
+    this->lastKnownBeaconIntervalStart += compensation;
+    return compensation;
+}
+
+uint16_t BeaconManager::getRxGuardTime() {
+    uint16_t uncertainty = this->driftEstimator.getUncertainty(this->dsme.getPlatform().getSymbolCounter());
+    return uncertainty < PRE_EVENT_SHIFT ? uncertainty : PRE_EVENT_SHIFT;
+}
+
 void BeaconManager::sendBeaconAllocationNotification(uint16_t beaconSDIndex) {
     LOG_INFO("Attempting to allocate BEACON at index " << beaconSDIndex << ".");
     IDSMEMessage* msg = dsme.getPlatform().getEmptyMessage();
@@ -374,7 +470,7 @@ void BeaconManager::sendBeaconAllocationNotification(uint16_t beaconSDIndex) {
 
     isBeaconAllocationSent = true;
 
-    if(!dsme.getMessageDispatcher().sendInCAP(msg)) {
+    if(!dsme.getMessageDispatcher().sendInCAP(msg, CAPClass::REPLY)) {
         isBeaconAllocationSent = false;
         dsme.getPlatform().releaseMessage(msg);
     }
@@ -431,7 +527,7 @@ void BeaconManager::sendBeaconCollisionNotification(uint16_t beaconSDIndex, cons
     msg->getHeader().setSrcPANId(this->dsme.getMAC_PIB().macPANId);
     msg->getHeader().setDstPANId(this->dsme.getMAC_PIB().macPANId);
 
-    if(!dsme.getMessageDispatcher().sendInCAP(msg)) {
+    if(!dsme.getMessageDispatcher().sendInCAP(msg, CAPClass::REPLY)) {
         // TODO
         dsme.getPlatform().releaseMessage(msg);
     }
@@ -51,6 +51,11 @@
 #include "../../mac_services/mlme_sap/MLME_SAP.h"
 #include "../../mac_services/mlme_sap/SCAN.h"
 #include "../ackLayer/AckLayer.h"
+#include "./ClockDriftEstimator.h"
+
+#ifndef DSME_TIME_CORRECTION_WINDOW
+#define DSME_TIME_CORRECTION_WINDOW 40
+#endif
 
 namespace dsme {
 
@@ -82,6 +87,34 @@ public:
 
     void handleBeacon(IDSMEMessage* msg);
 
+    /**
+     * Calculates the time correction for the sender of a frame received in a GTS (only for coordinators).
+     * Only the first frame of a GTS is sent at the slot boundary, so frames starting further than
+     * DSME_TIME_CORRECTION_WINDOW symbols away from a boundary are not considered.
+     * @return true, if the ACK for the frame shall carry a Time Correction IE
+     */
+    bool getTimeCorrection(IDSMEMessage* msg, int16_t& timeCorrection);
+
+    /**
+     * Called on reception of a Time Correction IE in an Enhanced-ACK.
+     * Keeps the synchronization to the SYNC parent without receiving its beacons,
+     * the correction is applied with the next preSuperframeEvent.
+     */
+    void handleTimeCorrection(const IEEE802154MacAddress& sender, int16_t timeCorrection);
+
+    /**
+     * Shifts the last known beacon interval start by the estimated drift against the SYNC parent.
+     * \param elapsedSymbols Symbols since the previous call
+     * \return The correction in symbols, that has to be applied to timers derived from the beacon interval start
+     */
+    int32_t compensateDrift(uint32_t elapsedSymbols);
+
+    /**
+     * Time in symbols the reception has to start before the expected beacon of the SYNC parent.
+     * This is at most PRE_EVENT_SHIFT, as the transceiver is turned on with the pre slot event at the latest.
+     */
+    uint16_t getRxGuardTime();
+
     bool isScanning() const;
 
     void startScanPassive(uint16_t scanDuration, const channelList_t& scanChannels);
@@ -130,6 +163,26 @@ protected:
 
     uint8_t missedBeacons;
 
+    /*
+     * Set once lastKnownBeaconIntervalStart was taken from the SFD timestamp of a beacon of the SYNC parent,
+     * time corrections by Enhanced-ACKs are only meaningful relative to that reference
+     */
+    bool timeCorrectionReferenceValid;
+
+    /*
+     * Latest time correction by an Enhanced-ACK, applied at the start of the next superframe
+     */
+    bool timeCorrectionPending;
+    int16_t pendingTimeCorrection;
+
+    /*
+     * Set if a time correction was applied since the last beacon of the SYNC parent
+     */
+    bool synchronizedByAck;
+
+    ClockDriftEstimator driftEstimator;
+    uint16_t driftEstimatorParent;
+
     /**
      * Send an enhanced Beacon directly
      */
@@ -0,0 +1,158 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "./ClockDriftEstimator.h"
+
+#include "../../../dsme_platform.h"
+
+namespace dsme {
+
+ClockDriftEstimator::ClockDriftEstimator() : samples{}, numSamples(0), next(0), driftPPM(0), residual(0), remainder(0) {
+}
+
+void ClockDriftEstimator::reset() {
+    this->numSamples = 0;
+    this->next = 0;
+    this->driftPPM = 0;
+    this->residual = 0;
+    this->remainder = 0;
+}
+
+void ClockDriftEstimator::addSample(uint32_t beaconIntervalStart, uint32_t beaconIntervalLength) {
+    if(this->numSamples > 0) {
+        /* the new sample has to be close to a multiple of the beacon interval after the latest one */
+        uint8_t latest = (this->next + DRIFT_ESTIMATOR_SAMPLES - 1) % DRIFT_ESTIMATOR_SAMPLES;
+        uint32_t elapsed = beaconIntervalStart - this->samples[latest];
+        if(elapsed < beaconIntervalLength / 2) {
+            /* '-> same beacon interval */
+            return;
+        }
+
+        uint32_t deviation = (elapsed + beaconIntervalLength / 2) % beaconIntervalLength;
+        if(deviation < beaconIntervalLength / 4 || deviation > beaconIntervalLength - beaconIntervalLength / 4) {
+            LOG_DEBUG("Restarting drift estimation");
+            reset();
+        }
+    }
+
+    this->samples[this->next] = beaconIntervalStart;
+    this->next = (this->next + 1) % DRIFT_ESTIMATOR_SAMPLES;
+    if(this->numSamples < DRIFT_ESTIMATOR_SAMPLES) {
+        this->numSamples++;
+    }
+
+    this->remainder = 0;
+    if(isValid()) {
+        estimate(beaconIntervalLength);
+    }
+}
+
+void ClockDriftEstimator::estimate(uint32_t beaconIntervalLength) {
+    /*
+     * Regression of the offset y against the number of beacon intervals k since the oldest sample,
+     * where y is the deviation of a sample from the nominal interval start.
+     */
+    int64_t k[DRIFT_ESTIMATOR_SAMPLES];
+    int64_t y[DRIFT_ESTIMATOR_SAMPLES];
+    int64_t sumK = 0;
+    int64_t sumY = 0;
+    int64_t sumKK = 0;
+    int64_t sumKY = 0;
+    int64_t n = this->numSamples;
+
+    uint8_t oldest = (this->next + DRIFT_ESTIMATOR_SAMPLES - this->numSamples) % DRIFT_ESTIMATOR_SAMPLES;
+    for(uint8_t i = 0; i < this->numSamples; i++) {
+        uint32_t elapsed = this->samples[(oldest + i) % DRIFT_ESTIMATOR_SAMPLES] - this->samples[oldest];
+        k[i] = (elapsed + beaconIntervalLength / 2) / beaconIntervalLength;
+        y[i] = (int64_t)elapsed - k[i] * beaconIntervalLength;
+
+        sumK += k[i];
+        sumY += y[i];
+        sumKK += k[i] * k[i];
+        sumKY += k[i] * y[i];
+    }
+
+    int64_t skk = n * sumKK - sumK * sumK;
+    int64_t sky = n * sumKY - sumK * sumY;
+    DSME_ASSERT(skk > 0);
+
+    /* slope in symbols per beacon interval, scaled to parts per million */
+    this->driftPPM = (sky * 1000000) / (skk * beaconIntervalLength);
+
+    /* y_i - (a + b * k_i) with b = sky / skk and a = (sumY - b * sumK) / n, scaled by n * skk */
+    int64_t maxDeviation = 0;
+    for(uint8_t i = 0; i < this->numSamples; i++) {
+        int64_t deviation = n * skk * y[i] - (skk * sumY - sky * sumK) - n * sky * k[i];
+        if(deviation < 0) {
+            deviation = -deviation;
+        }
+        if(deviation > maxDeviation) {
+            maxDeviation = deviation;
+        }
+    }
+    this->residual = (maxDeviation + n * skk - 1) / (n * skk);
+}
+
+int32_t ClockDriftEstimator::getCompensation(uint32_t elapsedSymbols) {
+    if(!isValid()) {
+        return 0;
+    }
+
+    int64_t total = (int64_t) this->driftPPM * elapsedSymbols + this->remainder;
+    int32_t compensation = total / 1000000;
+    this->remainder = total - (int64_t)compensation * 1000000;
+    return compensation;
+}
+
+uint16_t ClockDriftEstimator::getUncertainty(uint32_t now) const {
+    if(!isValid()) {
+        return UINT16_MAX;
+    }
+
+    /* the error of the estimated drift grows with the time since the latest beacon */
+    uint8_t latest = (this->next + DRIFT_ESTIMATOR_SAMPLES - 1) % DRIFT_ESTIMATOR_SAMPLES;
+    uint32_t elapsed = now - this->samples[latest];
+    uint32_t uncertainty = this->residual + ((uint64_t)elapsed * DSME_DRIFT_UNCERTAINTY_PPM) / 1000000 + 1;
+    return uncertainty > UINT16_MAX ? UINT16_MAX : uncertainty;
+}
+
+} /* namespace dsme */
@@ -0,0 +1,124 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CLOCKDRIFTESTIMATOR_H_
+#define CLOCKDRIFTESTIMATOR_H_
+
+#include "../../helper/Integers.h"
+
+#ifndef DSME_DRIFT_ESTIMATOR_SAMPLES
+#define DSME_DRIFT_ESTIMATOR_SAMPLES 4
+#endif
+
+#ifndef DSME_DRIFT_UNCERTAINTY_PPM
+#define DSME_DRIFT_UNCERTAINTY_PPM 10
+#endif
+
+namespace dsme {
+
+/* number of beacons of the SYNC parent that are considered for the estimation */
+constexpr uint8_t DRIFT_ESTIMATOR_SAMPLES = DSME_DRIFT_ESTIMATOR_SAMPLES;
+
+/**
+ * Estimates the drift of the local clock against the clock of the SYNC parent by a linear regression
+ * over the beacon interval starts derived from its beacons.
+ * The drift is given in parts per million, positive if the local clock is faster.
+ */
+class ClockDriftEstimator {
+public:
+    ClockDriftEstimator();
+
+    void reset();
+
+    /**
+     * Adds the start of a beacon interval as derived from a beacon of the SYNC parent.
+     * Samples that do not fit to the previous ones (e.g. after a resynchronization) restart the estimation.
+     * \param beaconIntervalLength Nominal length of a beacon interval in symbols
+     */
+    void addSample(uint32_t beaconIntervalStart, uint32_t beaconIntervalLength);
+
+    /**
+     * At least two samples are required for an estimation
+     */
+    bool isValid() const {
+        return numSamples >= 2;
+    }
+
+    int32_t getDriftPPM() const {
+        return driftPPM;
+    }
+
+    /**
+     * Largest deviation of a sample from the regression line in symbols
+     */
+    uint16_t getResidual() const {
+        return residual;
+    }
+
+    /**
+     * Correction in symbols for the given number of elapsed symbols.
+     * Fractions of a symbol are accumulated, so the corrections of consecutive calls add up to the drift.
+     */
+    int32_t getCompensation(uint32_t elapsedSymbols);
+
+    /**
+     * Uncertainty of the predicted beacon interval start in symbols
+     */
+    uint16_t getUncertainty(uint32_t now) const;
+
+private:
+    void estimate(uint32_t beaconIntervalLength);
+
+    uint32_t samples[DRIFT_ESTIMATOR_SAMPLES];
+    uint8_t numSamples;
+    uint8_t next;
+
+    int32_t driftPPM;
+    uint16_t residual;
+
+    /* fraction of a symbol in millionths that was not compensated yet */
+    int32_t remainder;
+};
+
+} /* namespace dsme */
+
+#endif /* CLOCKDRIFTESTIMATOR_H_ */
@@ -0,0 +1,111 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "./AdaptiveContentionController.h"
+
+#include "../../../dsme_platform.h"
+
+namespace dsme {
+
+AdaptiveContentionController::AdaptiveContentionController() : window(WINDOW_ONE) {
+}
+
+void AdaptiveContentionController::reset() {
+    this->window = WINDOW_ONE;
+}
+
+void AdaptiveContentionController::handleEndOfCAP(const CAPStatistics& statistics) {
+    const uint32_t ccaAttempts = statistics.failedCCAs + statistics.sentPackets;
+    if(ccaAttempts == 0) {
+        /* '-> nothing observed, e.g. superframe without CAP */
+        return;
+    }
+
+    uint32_t congestionPercent = (100 * statistics.failedCCAs) / ccaAttempts;
+    if(statistics.sentPackets > 0) {
+        const uint32_t failedPercent = (100 * statistics.failedPackets) / statistics.sentPackets;
+        if(failedPercent > congestionPercent) {
+            congestionPercent = failedPercent;
+        }
+    }
+
+    const uint16_t maxWindow = WINDOW_ONE << MAX_EXPONENT_OFFSET;
+    if(congestionPercent > CONGESTION_HIGH_PERCENT) {
+        this->window = (this->window < maxWindow / 2) ? 2 * this->window : maxWindow;
+    } else if(congestionPercent < CONGESTION_LOW_PERCENT && this->window > WINDOW_ONE) {
+        this->window--;
+    }
+
+    LOG_DEBUG("CAP contention " << congestionPercent << "%, window " << this->window << "/" << WINDOW_ONE);
+}
+
+uint8_t AdaptiveContentionController::getExponentOffset() const {
+    uint8_t offset = 0;
+    while((WINDOW_ONE << (offset + 1)) <= this->window) {
+        offset++;
+    }
+    return offset;
+}
+
+uint8_t AdaptiveContentionController::getMinBE(const MAC_PIB& pib) const {
+    const uint8_t minBE = pib.macMinBE + getExponentOffset();
+    const uint8_t maxBE = getMaxBE(pib);
+    return (minBE < maxBE) ? minBE : maxBE;
+}
+
+uint8_t AdaptiveContentionController::getMaxBE(const MAC_PIB& pib) const {
+    const uint8_t maxBE = pib.macMaxBE + getExponentOffset();
+    if(pib.macMaxBE >= MAX_BE_LIMIT) {
+        return pib.macMaxBE;
+    }
+    return (maxBE < MAX_BE_LIMIT) ? maxBE : MAX_BE_LIMIT;
+}
+
+uint8_t AdaptiveContentionController::getMaxCSMABackoffs(const MAC_PIB& pib) const {
+    const uint8_t maxBackoffs = pib.macMaxCSMABackoffs + getExponentOffset();
+    if(pib.macMaxCSMABackoffs >= MAX_CSMA_BACKOFFS_LIMIT) {
+        return pib.macMaxCSMABackoffs;
+    }
+    return (maxBackoffs < MAX_CSMA_BACKOFFS_LIMIT) ? maxBackoffs : MAX_CSMA_BACKOFFS_LIMIT;
+}
+
+} /* namespace dsme */
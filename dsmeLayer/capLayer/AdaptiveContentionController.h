@@ -0,0 +1,91 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef ADAPTIVECONTENTIONCONTROLLER_H_
+#define ADAPTIVECONTENTIONCONTROLLER_H_
+
+#include "../../helper/Integers.h"
+#include "./ContentionController.h"
+
+namespace dsme {
+
+/*
+ * Tunes the CSMA/CA parameters from the contention observed in the previous CAPs (not covered by the standard).
+ *
+ * The controller keeps a contention window factor. If the share of failed CCAs or failed transmissions in a CAP exceeds
+ * CONGESTION_HIGH_PERCENT, the factor is doubled, if it is below CONGESTION_LOW_PERCENT, it is decreased additively (AIMD on the
+ * sending rate). Every doubling of the factor raises the backoff exponents and macMaxCSMABackoffs by one.
+ */
+class AdaptiveContentionController : public ContentionController {
+public:
+    AdaptiveContentionController();
+
+    void reset() override;
+    void handleEndOfCAP(const CAPStatistics& statistics) override;
+
+    uint8_t getMinBE(const MAC_PIB& pib) const override;
+    uint8_t getMaxBE(const MAC_PIB& pib) const override;
+    uint8_t getMaxCSMABackoffs(const MAC_PIB& pib) const override;
+
+    /**
+     * Returns by how much the backoff exponents are currently raised
+     */
+    uint8_t getExponentOffset() const;
+
+private:
+    static constexpr uint8_t CONGESTION_HIGH_PERCENT = 30;
+    static constexpr uint8_t CONGESTION_LOW_PERCENT = 10;
+    static constexpr uint8_t MAX_EXPONENT_OFFSET = 4;
+
+    /* upper bounds given by the standard */
+    static constexpr uint8_t MAX_BE_LIMIT = 8;
+    static constexpr uint8_t MAX_CSMA_BACKOFFS_LIMIT = 5;
+
+    /* the window factor is stored in units of 1/WINDOW_ONE */
+    static constexpr uint16_t WINDOW_ONE = 8;
+
+    uint16_t window;
+};
+
+} /* namespace dsme */
+
+#endif /* ADAPTIVECONTENTIONCONTROLLER_H_ */
@@ -0,0 +1,117 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "./CAPClock.h"
+
+#include "../../../dsme_platform.h"
+#include "../../mac_services/pib/MAC_PIB.h"
+#include "../../mac_services/pib/PIBHelper.h"
+#include "../../mac_services/pib/dsme_mac_constants.h"
+#include "../DSMELayer.h"
+
+namespace dsme {
+
+CAPClock::CAPClock(DSMELayer& dsme) : dsme(dsme) {
+}
+
+uint32_t CAPClock::getCapFrameDuration() const {
+    const MAC_PIB& pib = this->dsme.getMAC_PIB();
+    if(pib.macCapReduction) {
+        return aNumSuperframeSlots * (uint32_t)aBaseSlotDuration * (1 << (uint32_t)pib.macMultiSuperframeOrder);
+    } else {
+        return aNumSuperframeSlots * (uint32_t)aBaseSlotDuration * (1 << (uint32_t)pib.macSuperframeOrder);
+    }
+}
+
+uint32_t CAPClock::getSymbolsSinceCapFrameStart(uint32_t time) const {
+    uint32_t symbolsSinceLastBeaconInterval = time - this->dsme.getBeaconManager().getLastKnownBeaconIntervalStart();
+    return symbolsSinceLastBeaconInterval % getCapFrameDuration();
+}
+
+uint32_t CAPClock::getCapStart() const {
+    return this->dsme.getMAC_PIB().helper.getSymbolsPerSlot(); // after beacon slot
+}
+
+uint32_t CAPClock::getCapEnd() const {
+    return this->dsme.getMAC_PIB().helper.getSymbolsPerSlot() * (this->dsme.getMAC_PIB().helper.getFinalCAPSlot(0) + 1) - PRE_EVENT_SHIFT;
+}
+
+bool CAPClock::isWithinCAP(uint32_t time, uint16_t duration) const {
+    uint32_t symbolsSinceCapFrameStart = getSymbolsSinceCapFrameStart(time);
+
+    return (symbolsSinceCapFrameStart >= getCapStart())              // after beacon slot
+           && (symbolsSinceCapFrameStart + duration <= getCapEnd()); // before pre-event of first GTS
+}
+
+uint32_t CAPClock::toTicks(uint32_t time, uint16_t tickLength, uint32_t usableLength, uint32_t& capFrameStart) const {
+    const uint32_t ticksPerCap = usableLength / tickLength;
+    DSME_ASSERT(ticksPerCap > 0);
+
+    const uint32_t symbolsSinceCapFrameStart = getSymbolsSinceCapFrameStart(time);
+    const uint32_t capStart = getCapStart();
+    capFrameStart = time - symbolsSinceCapFrameStart;
+
+    if(symbolsSinceCapFrameStart <= capStart) {
+        /* '-> currently in beacon slot before CAP */
+        return 0;
+    }
+
+    const uint32_t ticks = (symbolsSinceCapFrameStart - capStart + tickLength - 1) / tickLength;
+    if(ticks < ticksPerCap) {
+        /* '-> currently inside CAP */
+        return ticks;
+    } else {
+        /* '-> after CAP */
+        return ticksPerCap;
+    }
+}
+
+uint32_t CAPClock::toTime(uint32_t capFrameStart, uint32_t ticks, uint16_t tickLength, uint32_t usableLength) const {
+    const uint32_t ticksPerCap = usableLength / tickLength;
+    DSME_ASSERT(ticksPerCap > 0);
+
+    const uint32_t capFrames = ticks / ticksPerCap;
+    const uint32_t ticksInCap = ticks % ticksPerCap;
+    return capFrameStart + capFrames * getCapFrameDuration() + getCapStart() + ticksInCap * tickLength;
+}
+
+} /* namespace dsme */
@@ -0,0 +1,115 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CAPCLOCK_H_
+#define CAPCLOCK_H_
+
+#include "../../helper/Integers.h"
+
+namespace dsme {
+
+class DSMELayer;
+
+/**
+ * Closed-form mapping between the symbol counter and the time within the CAPs.
+ *
+ * A CAP frame is the period that contains exactly one CAP: a multi-superframe if macCapReduction is set, a superframe otherwise.
+ * The CAP clock counts ticks of a fixed length (e.g. aUnitBackoffPeriod) that only advance during the first usable symbols of
+ * each CAP, so a backoff can be placed behind an arbitrary number of (reduced) superframes without iterating over them.
+ */
+class CAPClock {
+public:
+    explicit CAPClock(DSMELayer& dsme);
+
+    /**
+     * Returns the duration of a CAP frame in symbols.
+     */
+    uint32_t getCapFrameDuration() const;
+
+    uint32_t getSymbolsSinceCapFrameStart(uint32_t time) const;
+
+    /**
+     * Returns the offset of the CAP start from the start of the CAP frame, i.e. the end of the beacon slot.
+     */
+    uint32_t getCapStart() const;
+
+    /**
+     * Returns the offset of the CAP end from the start of the CAP frame, i.e. the pre-event of the first GTS.
+     */
+    uint32_t getCapEnd() const;
+
+    /** Checks if \p time + \p duration is within a CAP.
+     *\param time Time in symbols
+     *\param duration Duration in symbols
+     *\return \p true if \p time + \p duration is within a CAP, \p false otherwise
+     */
+    bool isWithinCAP(uint32_t time, uint16_t duration) const;
+
+    /**
+     * Maps a time to the first CAP clock tick not before it.
+     * Ticks are counted from the CAP start of the CAP frame containing \p time, a time after the usable part of the CAP is mapped to the
+     * first tick of the next CAP frame.
+     * \param time Time in symbols
+     * \param tickLength Length of a tick in symbols
+     * \param usableLength Number of symbols at the start of every CAP in which ticks may start
+     * \param capFrameStart Returns the start of the CAP frame containing \p time
+     * \return The number of ticks since the CAP start of \p capFrameStart
+     */
+    uint32_t toTicks(uint32_t time, uint16_t tickLength, uint32_t usableLength, uint32_t& capFrameStart) const;
+
+    /**
+     * Maps a CAP clock tick back to the symbol counter.
+     * \param capFrameStart Start of the CAP frame the ticks are counted from
+     * \param ticks Number of ticks since the CAP start of \p capFrameStart
+     * \param tickLength Length of a tick in symbols
+     * \param usableLength Number of symbols at the start of every CAP in which ticks may start
+     * \return The time in symbols the tick starts at
+     */
+    uint32_t toTime(uint32_t capFrameStart, uint32_t ticks, uint16_t tickLength, uint32_t usableLength) const;
+
+private:
+    DSMELayer& dsme;
+};
+
+} /* namespace dsme */
+
+#endif /* CAPCLOCK_H_ */
@@ -57,7 +57,7 @@
 namespace dsme {
 
 CAPLayer::CAPLayer(DSMELayer& dsme)
-    : DSMEBufferedFSM<CAPLayer, CSMAEvent, 4>(&CAPLayer::stateIdle), dsme(dsme), NB(0), NR(0), totalNBs(0), CW(CW0), batteryLifeExt(false), slottedCSMA(true), sentPackets(0), failedPackets(0), successPackets(0), failedCCAs(0), doneCallback(DELEGATE(&CAPLayer::sendDone, *this)) {
+    : DSMEBufferedFSM<CAPLayer, CSMAEvent, 4>(&CAPLayer::stateIdle), dsme(dsme), NB(0), NR(0), totalNBs(0), CW(CW0), batteryLifeExt(false), slottedCSMA(true), sentPackets(0), failedPackets(0), successPackets(0), failedCCAs(0), doneCallback(DELEGATE(&CAPLayer::sendDone, *this)), contentionController(&defaultContentionController), pipelining(false), parked(nullptr), servingParked(false), parkedDeferred(false), parkedNR(0), parkedTotalNBs(0) {
         if(!slottedCSMA) {
             batteryLifeExt = false;
         }
@@ -69,10 +69,16 @@ void CAPLayer::reset() {
     this->totalNBs = 0;
     this->NR = 0;
     this->CW = CW0;
+    this->contentionController->reset();
 
+    this->servingParked = false;
     while(!this->queue.empty()) {
         actionPopMessage(DataStatus::Data_Status::TRANSACTION_EXPIRED);
     }
+    if(this->parked != nullptr) {
+        this->servingParked = true;
+        actionPopMessage(DataStatus::Data_Status::TRANSACTION_EXPIRED);
+    }
 }
 
 /*****************************
@@ -110,16 +116,16 @@ void CAPLayer::sendDone(AckLayerResponse response, IDSMEMessage* msg) {
     DSME_ASSERT(dispatchSuccessful);
 }
 
-bool CAPLayer::pushMessage(IDSMEMessage* msg) {
-    LOG_DEBUG("push");
+bool CAPLayer::pushMessage(IDSMEMessage* msg, CAPClass::CAP_Class capClass) {
+    LOG_DEBUG("push " << (uint16_t)capClass);
 
     bool pushed = false;
 
     DSME_ATOMIC_BLOCK {
-        if(this->queue.full()) {
+        if(this->queue.full(capClass)) {
             pushed = false;
         } else {
-            this->queue.push(msg);
+            this->queue.push(msg, capClass);
             pushed = true;
         }
     }
@@ -131,13 +137,23 @@ bool CAPLayer::pushMessage(IDSMEMessage* msg) {
     return pushed;
 }
 
+void CAPLayer::setClassLimit(CAPClass::CAP_Class capClass, uint16_t limit) {
+    DSME_ATOMIC_BLOCK {
+        this->queue.setClassLimit(capClass, limit);
+    }
+}
+
+bool CAPLayer::isWaitingForAccess(IDSMEMessage* msg) {
+    return msg != this->parked && !this->queue.isSelected(msg);
+}
+
 /*****************************
  * Choices
  *****************************/
 fsmReturnStatus CAPLayer::choiceRebackoff() {
     NB++;
     CW = CW0;
-    if(NB > dsme.getMAC_PIB().macMaxCSMABackoffs) {
+    if(NB > contentionController->getMaxCSMABackoffs(dsme.getMAC_PIB())) {
         actionPopMessage(DataStatus::CHANNEL_ACCESS_FAILURE);
         return transition(&CAPLayer::stateIdle);
     } else {
@@ -155,7 +171,7 @@ fsmReturnStatus CAPLayer::stateIdle(CSMAEvent& event) {
         totalNBs = 0;
         CW = CW0;
 
-        if(!queue.empty()) {
+        if(selectMessage()) {
             return transition(&CAPLayer::stateBackoff);
         } else {
             return FSM_HANDLED;
@@ -163,6 +179,7 @@ fsmReturnStatus CAPLayer::stateIdle(CSMAEvent& event) {
     } else if(event.signal == CSMAEvent::MSG_PUSHED) {
         LOG_INFO("A CSMA message was pushed.");
         DSME_ASSERT(!queue.empty());
+        selectMessage();
         return transition(&CAPLayer::stateBackoff);
     } else if(event.signal == CSMAEvent::CCA_SUCCESS || event.signal == CSMAEvent::CCA_FAILURE) {
         /* '-> only possible after reset */
@@ -170,7 +187,7 @@ fsmReturnStatus CAPLayer::stateIdle(CSMAEvent& event) {
     } else if(event.signal == CSMAEvent::SEND_ABORTED) {
         // After a RESET, events might arrive for
         // messages already signaled as expired to upper layer
-        DSME_ASSERT(this->queue.empty());
+        DSME_ASSERT(this->queue.empty() && this->parked == nullptr);
         return FSM_IGNORED;
     } else {
         if(event.signal >= CSMAEvent::USER_SIGNAL_START) {
@@ -268,7 +285,7 @@ fsmReturnStatus CAPLayer::stateContention(CSMAEvent& event) {
 
 fsmReturnStatus CAPLayer::stateSending(CSMAEvent& event) {
     if(event.signal == CSMAEvent::ENTRY_SIGNAL) {
-        if(!dsme.getAckLayer().prepareSendingCopy(queue.front(), doneCallback)) {
+        if(!dsme.getAckLayer().prepareSendingCopy(currentMessage(), doneCallback)) {
             // currently receiving external interference
             return choiceRebackoff();
         }
@@ -291,6 +308,10 @@ fsmReturnStatus CAPLayer::stateSending(CSMAEvent& event) {
             NB = 0;
             CW=CW0;
             NR++;
+            if(pipelining && tryPark()) {
+                /* '-> the next frame is sent during the retry backoff of this one */
+                return transition(&CAPLayer::stateIdle);
+            }
             return transition(&CAPLayer::stateBackoff);
         }
     } else if(event.signal == CSMAEvent::SEND_ABORTED) {
@@ -309,7 +330,7 @@ fsmReturnStatus CAPLayer::stateSending(CSMAEvent& event) {
  * Actions & Helpers
  *****************************/
 uint16_t CAPLayer::symbolsRequired() {
-    IDSMEMessage* msg = queue.front();
+    IDSMEMessage* msg = currentMessage();
     uint16_t symbols = 0;
     symbols += 8; // CCA
     if(slottedCSMA)
@@ -321,6 +342,13 @@ uint16_t CAPLayer::symbolsRequired() {
 }
 
 void CAPLayer::handleStartOfCFP() {
+    CAPStatistics statistics;
+    statistics.sentPackets = sentPackets;
+    statistics.failedPackets = failedPackets;
+    statistics.successPackets = successPackets;
+    statistics.failedCCAs = failedCCAs;
+    this->contentionController->handleEndOfCAP(statistics);
+
     this->dsme.getPlatform().signalPRRCAP(((double)(sentPackets - failedPackets) / sentPackets));
     this->dsme.getPlatform().signalFailedPacketsPerCAP(failedPackets);
     failedPackets = 0;
@@ -340,94 +368,135 @@ void CAPLayer::setBLE(bool ble) {
     batteryLifeExt = ble;
 }
 
+void CAPLayer::setPipelining(bool pipelining) {
+    this->pipelining = pipelining;
+}
+
+void CAPLayer::setContentionController(ContentionController* controller) {
+    if(controller == nullptr) {
+        controller = &defaultContentionController;
+    }
+    controller->reset();
+    contentionController = controller;
+}
+
 void CAPLayer::actionStartBackoffTimer() {
     totalNBs++;
 
     uint8_t backoffExp;
 
-    if((int)this->dsme.getMAC_PIB().macMinBE < 2 || !batteryLifeExt || !slottedCSMA) {
-        backoffExp = this->dsme.getMAC_PIB().macMinBE + NB;
+    uint8_t minBE = this->contentionController->getMinBE(this->dsme.getMAC_PIB());
+    if(isPrioritized(currentMessage())) {
+        /* '-> prioritized channel access with a shortened backoff and contention window */
+        minBE = getPriorityMinBE(minBE);
+        CW = CW0_PRIORITY;
+    }
+    if((int)minBE < 2 || !batteryLifeExt || !slottedCSMA) {
+        backoffExp = minBE + NB;
     } else {
         backoffExp = 2 + NB;
     }
     
-    const uint8_t maxBE = this->dsme.getMAC_PIB().macMaxBE;
+    const uint8_t maxBE = this->contentionController->getMaxBE(this->dsme.getMAC_PIB());
     backoffExp = backoffExp <= maxBE ? backoffExp : maxBE;
 
     const uint16_t unitBackoffPeriods = this->dsme.getPlatform().getRandom() % (1 << (uint16_t)backoffExp);
 
     const uint16_t backoff = aUnitBackoffPeriod * (unitBackoffPeriods + 1); // +1 to avoid scheduling in the past
-    const uint32_t symbolsPerSlot = this->dsme.getMAC_PIB().helper.getSymbolsPerSlot();
-    const uint16_t blockedEnd = symbolsRequired() + PRE_EVENT_SHIFT;
-    const uint32_t capPhaseLength = dsme.getMAC_PIB().helper.getFinalCAPSlot(0) * symbolsPerSlot;
-    const uint32_t usableCapPhaseLength = capPhaseLength - blockedEnd;
-    const uint32_t usableCapPhaseEnd = usableCapPhaseLength + symbolsPerSlot;
-    
+    const uint16_t required = symbolsRequired();
+    const CAPClock& capClock = this->dsme.getCapClock();
+    const uint32_t capPhaseLength = capClock.getCapEnd() + PRE_EVENT_SHIFT - capClock.getCapStart();
+    const uint32_t reservedSymbols = required + PRE_EVENT_SHIFT;
+    DSME_ASSERT(capPhaseLength > reservedSymbols);
+    const uint32_t usableCapPhaseLength = capPhaseLength - reservedSymbols;
+
+    /* In slotted mode the backoff counts backoff periods aligned to the CAP start, otherwise single symbols */
+    const uint16_t tickLength = slottedCSMA ? aUnitBackoffPeriod : 1;
+    const uint32_t backoffTicks = slottedCSMA ? unitBackoffPeriods + 1 : backoff;
 
     DSME_ATOMIC_BLOCK {
         const uint32_t now = this->dsme.getPlatform().getSymbolCounter();
-        const uint32_t symbolsSinceCapFrameStart = this->dsme.getSymbolsSinceCapFrameStart(now);
-        const uint32_t CAPStart = now + symbolsPerSlot - symbolsSinceCapFrameStart;
-
-        uint32_t backoffFromCAPStart;
-        if(symbolsSinceCapFrameStart < symbolsPerSlot) {
-            /* '-> currently in beacon slot before CAP */
-            backoffFromCAPStart = backoff;
-        } else if(symbolsSinceCapFrameStart < usableCapPhaseEnd) {
-            /* '-> currently inside CAP */
-            backoffFromCAPStart = backoff + symbolsSinceCapFrameStart - symbolsPerSlot;
-        } else {
-            /* '-> after CAP */
-            backoffFromCAPStart = backoff + usableCapPhaseLength;
-        }
-        
-        uint32_t backOffTimeLeft = backoffFromCAPStart;
-
-        // Backoff period synchronisation
-        if(slottedCSMA && backOffTimeLeft % aUnitBackoffPeriod != 0) {
-            backOffTimeLeft -= backOffTimeLeft % aUnitBackoffPeriod;
-            backOffTimeLeft += aUnitBackoffPeriod; // To avoid scheduling earlier than initial backoff
-        }
 
-        const uint16_t superFramesPerMultiSuperframe = 1 << (this->dsme.getMAC_PIB().macMultiSuperframeOrder - this->dsme.getMAC_PIB().macSuperframeOrder);
-
-        const uint16_t startingSuperframe = 1;
-        uint16_t superframeIterator = startingSuperframe;
-        while(backOffTimeLeft > usableCapPhaseLength) {
-            if(!this->dsme.getMAC_PIB().macCapReduction || superframeIterator % superFramesPerMultiSuperframe == 0) {
-                /* '-> this superframe contains a CAP phase */
-                backOffTimeLeft -= usableCapPhaseLength;
-                if(slottedCSMA) {
-                    /* Resync to backoff period */
-                    backOffTimeLeft -= backOffTimeLeft % aUnitBackoffPeriod;
-                    backOffTimeLeft += aUnitBackoffPeriod;
-                }
-            }
-            superframeIterator++;
-        }
-
-        const uint16_t superframesToWait = superframeIterator - startingSuperframe;
-        const uint32_t superFrameDuration = this->dsme.getMAC_PIB().helper.getSymbolsPerSlot() * aNumSuperframeSlots;
-        const uint32_t totalWaitTime = backOffTimeLeft + superFrameDuration * superframesToWait;
+        uint32_t capFrameStart;
+        const uint32_t ticks = capClock.toTicks(now, tickLength, usableCapPhaseLength, capFrameStart) + backoffTicks;
+        const uint32_t timerEndTime = capClock.toTime(capFrameStart, ticks, tickLength, usableCapPhaseLength);
 
-        const uint32_t timerEndTime = CAPStart + totalWaitTime;
         DSME_ASSERT(timerEndTime >= now + backoff);
-        if(!this->dsme.isWithinCAP(timerEndTime, symbolsRequired())) {
+        if(!capClock.isWithinCAP(timerEndTime, required)) {
             LOG_INFO("Not within CAP-phase in superframe " << dsme.getCurrentSuperframe());
-            LOG_ERROR("now: " << now << ", CAPStart: " << CAPStart << ", totalWaitTime: " << totalWaitTime << ", symbolsRequired: " << symbolsRequired());
+            LOG_ERROR("now: " << now << ", capFrameStart: " << capFrameStart << ", ticks: " << ticks << ", symbolsRequired: " << required);
             DSME_ASSERT(false);
         }
         this->dsme.getEventDispatcher().setupCSMATimer(timerEndTime);
     }
 }
 
+IDSMEMessage* CAPLayer::currentMessage() {
+    return servingParked ? parked : queue.front();
+}
+
+bool CAPLayer::selectMessage() {
+    if(parked != nullptr && (!parkedDeferred || queue.empty())) {
+        /* '-> continue with the retries of the parked frame */
+        servingParked = true;
+        NR = parkedNR;
+        totalNBs = parkedTotalNBs;
+        return true;
+    }
+    servingParked = false;
+    return !queue.empty();
+}
+
+bool CAPLayer::tryPark() {
+    if(servingParked) {
+        if(queue.empty() || queue.front()->getHeader().getDestAddr() == parked->getHeader().getDestAddr()) {
+            return false;
+        }
+    } else {
+        if(parked != nullptr || queue.getSize() < 2) {
+            return false;
+        }
+        bool sameDestination;
+        DSME_ATOMIC_BLOCK {
+            sameDestination = queue.second()->getHeader().getDestAddr() == queue.front()->getHeader().getDestAddr();
+            if(!sameDestination) {
+                parked = queue.front();
+                queue.pop();
+            }
+        }
+        if(sameDestination) {
+            /* '-> the next frame would meet the same conditions at the receiver, keep retrying the current one */
+            return false;
+        }
+    }
+
+    LOG_DEBUG("park 0x" << HEXOUT << parked->getHeader().getDestAddr().getShortAddress() << DECOUT);
+    parkedNR = NR;
+    parkedTotalNBs = totalNBs;
+    parkedDeferred = true;
+    servingParked = false;
+    return true;
+}
+
+bool CAPLayer::isPrioritized(IDSMEMessage* msg) {
+    return dsme.getMAC_PIB().macPriorityChannelAccess && msg->trafficClass == TrafficClass::CRITICAL;
+}
+
 bool CAPLayer::enoughTimeLeft() {
     return dsme.isWithinCAP(dsme.getPlatform().getSymbolCounter(), symbolsRequired());
 }
 
 void CAPLayer::actionPopMessage(DataStatus::Data_Status status) {
-    IDSMEMessage* msg = queue.front();
-    queue.pop();
+    IDSMEMessage* msg;
+    if(servingParked) {
+        msg = parked;
+        parked = nullptr;
+        servingParked = false;
+    } else {
+        msg = queue.front();
+        queue.pop();
+        parkedDeferred = false;
+    }
 
     uint8_t transmissionAttempts = NR + 1;
 
@@ -46,10 +46,12 @@
 #include "../../../dsme_settings.h"
 #include "../../helper/DSMEBufferedFSM.h"
 #include "../../helper/DSMEFSM.h"
-#include "../../helper/DSMEQueue.h"
 #include "../../helper/Integers.h"
 #include "../../mac_services/DSME_Common.h"
 #include "../ackLayer/AckLayer.h"
+#include "./CAPQueue.h"
+#include "./ContentionController.h"
+#include "./PriorityAccess.h"
 
 namespace dsme {
 
@@ -70,13 +72,34 @@ class CAPLayer : private DSMEBufferedFSM<CAPLayer, CSMAEvent, 4> {
 public:
     explicit CAPLayer(DSMELayer& dsme);
     void reset();
-    bool pushMessage(IDSMEMessage* msg);
+    bool pushMessage(IDSMEMessage* msg, CAPClass::CAP_Class capClass);
+    void setClassLimit(CAPClass::CAP_Class capClass, uint16_t limit);
+
+    /**
+     * Checks if channel access for a pushed message has not started yet, so the message may still be modified.
+     * Must be called within an atomic block and only for messages that were pushed and not yet reported as sent.
+     */
+    bool isWaitingForAccess(IDSMEMessage* msg);
     void dispatchTimerEvent();
     void dispatchCCAResult(bool success);
     void handleStartOfCFP();
     void setSlottedCSMA(bool slotted);
     void setBLE(bool ble);
 
+    /**
+     * Replaces the policy selecting the CSMA/CA parameters, ownership STAYS with caller
+     * @param controller the new policy, nullptr restores the fixed parameters from the MAC PIB
+     */
+    void setContentionController(ContentionController* controller);
+
+    /**
+     * Enables the dual-frame pipeline (not covered by the standard).
+     * A frame that has to be retried is parked, so the next queued frame can be sent during its retry backoff.
+     * Frames from the queue and the parked frame are then served alternately.
+     * A frame is only parked if the frame served instead has another destination, a busy receiver would fail both.
+     */
+    void setPipelining(bool pipelining);
+
 private:
     /**
      * States
@@ -103,6 +126,10 @@ private:
      */
     fsmReturnStatus choiceRebackoff();
     bool enoughTimeLeft();
+    bool isPrioritized(IDSMEMessage* msg);
+    IDSMEMessage* currentMessage();
+    bool selectMessage();
+    bool tryPark();
     uint16_t symbolsRequired();
 
     /**
@@ -113,11 +140,24 @@ private:
     uint8_t NR;
     uint8_t CW;
     static const uint8_t CW0 = 2;
+    static const uint8_t CW0_PRIORITY = 1; // contention window of critical frames with prioritized channel access
     bool batteryLifeExt;
     bool slottedCSMA;
     uint8_t totalNBs;
     AckLayer::done_callback_t doneCallback;
-    DSMEQueue<IDSMEMessage*, CAP_QUEUE_SIZE> queue;
+    ContentionController defaultContentionController;
+    ContentionController* contentionController;
+    CAPQueue<IDSMEMessage*, CAP_QUEUE_SIZE> queue;
+
+    /**
+     * Dual-frame pipeline
+     */
+    bool pipelining;
+    IDSMEMessage* parked;   // frame waiting for a retry while frames from the queue are sent
+    bool servingParked;     // the current frame is the parked one instead of the front of the queue
+    bool parkedDeferred;    // the parked frame waits until the next frame from the queue is finished
+    uint8_t parkedNR;
+    uint8_t parkedTotalNBs;
 
     /**
      * Counters for statistics
@@ -0,0 +1,219 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CAPQUEUE_H_
+#define CAPQUEUE_H_
+
+#include "../../helper/Integers.h"
+#include "../../mac_services/DSME_Common.h"
+
+namespace dsme {
+
+/**
+ * A queue for messages waiting for a CAP transmission.
+ * Every CAP class has its own FIFO, the classes are served in strict priority order.
+ * All FIFOs are linked lists within the same pool of S entries, so the classes do not need separate buffers.
+ * Once the front element was requested, it stays the front element until it is popped, even if a message
+ * of a higher priority class arrives in the meantime. This keeps the message that is currently processed
+ * by the CSMA/CA stable.
+ * @template-param T type of elements to store
+ * @template-param S maximum number of elements in all classes together
+ */
+template <typename T, uint16_t S>
+class CAPQueue {
+public:
+    CAPQueue() : elements{}, freeHead(0), current(NUM_CAP_CLASSES), size(0) {
+        for(uint8_t i = 0; i < NUM_CAP_CLASSES; i++) {
+            this->head[i] = NONE;
+            this->tail[i] = NONE;
+            this->classOccupancy[i] = 0;
+            this->classLimit[i] = S;
+        }
+
+        /* link all entries to the list of free entries */
+        for(uint16_t i = 0; i < S; i++) {
+            this->next[i] = i + 1;
+        }
+    }
+
+    // assumes queue is not full for the class
+    void push(T& element, uint8_t capClass) {
+        DSME_ASSERT(capClass < NUM_CAP_CLASSES);
+        DSME_ASSERT(!full(capClass));
+
+        uint16_t entry = freeHead;
+        freeHead = next[entry];
+
+        elements[entry] = element;
+        next[entry] = NONE;
+        if(head[capClass] == NONE) {
+            head[capClass] = entry;
+        } else {
+            next[tail[capClass]] = entry;
+        }
+        tail[capClass] = entry;
+
+        classOccupancy[capClass]++;
+        size++;
+    }
+
+    // assumes queue is not empty
+    void pop() {
+        front();
+        uint16_t entry = head[current];
+        head[current] = next[entry];
+        if(head[current] == NONE) {
+            tail[current] = NONE;
+        }
+
+        next[entry] = freeHead;
+        freeHead = entry;
+
+        classOccupancy[current]--;
+        size--;
+        current = NUM_CAP_CLASSES;
+    }
+
+    // assumes queue is not empty
+    T& front() {
+        DSME_ASSERT(size > 0);
+        if(current == NUM_CAP_CLASSES) {
+            /* '-> select the highest priority non-empty class */
+            current = 0;
+            while(head[current] == NONE) {
+                current++;
+            }
+        }
+        return elements[head[current]];
+    }
+
+    /**
+     * Returns the element that becomes the front element once the current front element is popped
+     * assumes the queue holds at least two elements
+     */
+    T& second() {
+        DSME_ASSERT(size > 1);
+        front();
+        uint8_t capClass = 0;
+        uint16_t entry = (current == 0) ? next[head[0]] : head[0];
+        while(entry == NONE) {
+            capClass++;
+            entry = (capClass == current) ? next[head[capClass]] : head[capClass];
+        }
+        return elements[entry];
+    }
+
+    /**
+     * Checks if the element was already selected as front element, i.e. it is processed by the CSMA/CA
+     * @param element the element to look for
+     */
+    bool isSelected(const T& element) {
+        return current != NUM_CAP_CLASSES && elements[head[current]] == element;
+    }
+
+    uint16_t getSize() const {
+        return size;
+    }
+
+    bool empty() const {
+        return (size == 0);
+    }
+
+    bool full() const {
+        return (size >= S);
+    }
+
+    /**
+     * Checks if another message of the given class can be queued
+     * @param capClass the class to check
+     */
+    bool full(uint8_t capClass) const {
+        return full() || classOccupancy[capClass] >= classLimit[capClass];
+    }
+
+    /**
+     * Limits the number of entries a class may occupy
+     * @param capClass the class to limit
+     * @param limit maximum number of entries, at most S
+     */
+    void setClassLimit(uint8_t capClass, uint16_t limit) {
+        classLimit[capClass] = (limit < S) ? limit : S;
+    }
+
+    uint16_t getClassOccupancy(uint8_t capClass) const {
+        return classOccupancy[capClass];
+    }
+
+private:
+    /* marks the end of a list */
+    static constexpr uint16_t NONE = S;
+
+    T elements[S];
+
+    /* following entry of the same class, or following free entry */
+    uint16_t next[S];
+
+    /* first and last entry of each class */
+    uint16_t head[NUM_CAP_CLASSES];
+    uint16_t tail[NUM_CAP_CLASSES];
+
+    /* first entry of the list of free entries */
+    uint16_t freeHead;
+
+    /* class of the current front element, NUM_CAP_CLASSES if none was selected yet */
+    uint8_t current;
+
+    uint16_t size;
+
+    /* number of entries currently occupied by each class */
+    uint16_t classOccupancy[NUM_CAP_CLASSES];
+
+    /* maximum number of entries each class may occupy */
+    uint16_t classLimit[NUM_CAP_CLASSES];
+};
+
+template <typename T, uint16_t S>
+constexpr uint16_t CAPQueue<T, S>::NONE;
+
+} /* namespace dsme */
+
+#endif /* CAPQUEUE_H_ */
@@ -0,0 +1,93 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CONTENTIONCONTROLLER_H_
+#define CONTENTIONCONTROLLER_H_
+
+#include "../../helper/Integers.h"
+#include "../../mac_services/pib/MAC_PIB.h"
+
+namespace dsme {
+
+/*
+ * Statistics of the CSMA/CA collected during one CAP
+ */
+struct CAPStatistics {
+    uint32_t sentPackets;
+    uint32_t failedPackets;
+    uint32_t successPackets;
+    uint32_t failedCCAs;
+};
+
+/*
+ * Selects the CSMA/CA parameters used by the CAPLayer.
+ * The default implementation returns the values from the MAC PIB unchanged.
+ */
+class ContentionController {
+public:
+    virtual ~ContentionController() = default;
+
+    virtual void reset() {
+    }
+
+    /**
+     * Called at the end of every CAP with the statistics collected during that CAP
+     */
+    virtual void handleEndOfCAP(const CAPStatistics& /* statistics */) {
+    }
+
+    virtual uint8_t getMinBE(const MAC_PIB& pib) const {
+        return pib.macMinBE;
+    }
+
+    virtual uint8_t getMaxBE(const MAC_PIB& pib) const {
+        return pib.macMaxBE;
+    }
+
+    virtual uint8_t getMaxCSMABackoffs(const MAC_PIB& pib) const {
+        return pib.macMaxCSMABackoffs;
+    }
+};
+
+} /* namespace dsme */
+
+#endif /* CONTENTIONCONTROLLER_H_ */
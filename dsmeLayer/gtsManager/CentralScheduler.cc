@@ -0,0 +1,570 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "./CentralScheduler.h"
+
+#include "../../../dsme_platform.h"
+#include "../../mac_services/dataStructures/DSMEAllocationCounterTable.h"
+#include "../../mac_services/dataStructures/IEEE802154MacAddress.h"
+#include "../../mac_services/dataStructures/LinkQualityTable.h"
+#include "../../mac_services/pib/MAC_PIB.h"
+#include "../../mac_services/pib/PIBHelper.h"
+#include "../DSMELayer.h"
+#include "../messages/MACCommand.h"
+
+namespace dsme {
+
+CentralScheduler::CentralScheduler(DSMELayer& dsme) : dsme(dsme) {
+}
+
+void CentralScheduler::reset() {
+    while(this->ownDemands.size() > 0) {
+        auto it = this->ownDemands.begin();
+        this->ownDemands.remove(it);
+    }
+    while(this->demands.size() > 0) {
+        auto it = this->demands.begin();
+        this->demands.remove(it);
+    }
+    this->ownDemandsChanged = false;
+    this->multiSuperframesSinceReport = 0;
+    this->demandsChanged = false;
+    this->numAllocations = 0;
+    this->multiSuperframesSincePush = 0;
+    this->hasPushVersion = false;
+    this->receivedFragments = 0;
+}
+
+void CentralScheduler::beginDemands() {
+    for(RBTree<CentralOwnDemand, uint16_t>::iterator it = this->ownDemands.begin(); it != this->ownDemands.end(); ++it) {
+        it->refreshed = false;
+    }
+}
+
+void CentralScheduler::setDemand(uint16_t destination, uint8_t slotDemand) {
+    RBTree<CentralOwnDemand, uint16_t>::iterator it = this->ownDemands.find(destination);
+    if(it == this->ownDemands.end()) {
+        if(slotDemand > 0 && this->ownDemands.size() < SCHEDULE_REPORT_MAX_LINKS) {
+            this->ownDemands.insert(CentralOwnDemand{slotDemand, true}, destination);
+            this->ownDemandsChanged = true;
+        }
+        return;
+    }
+
+    it->refreshed = true;
+    if(it->slotDemand != slotDemand) {
+        /* '-> a demand of 0 stays in the next report, so the PAN coordinator releases the slots right away */
+        it->slotDemand = slotDemand;
+        this->ownDemandsChanged = true;
+    }
+}
+
+void CentralScheduler::endDemands() {
+    for(RBTree<CentralOwnDemand, uint16_t>::iterator it = this->ownDemands.begin(); it != this->ownDemands.end(); ++it) {
+        if(!it->refreshed && it->slotDemand > 0) {
+            /* '-> the link disappeared */
+            it->slotDemand = 0;
+            this->ownDemandsChanged = true;
+        }
+    }
+}
+
+void CentralScheduler::removeReleasedDemands() {
+    /* the iterator is invalidated by the removal, so the search starts over after every removal */
+    bool removed = true;
+    while(removed) {
+        removed = false;
+        for(RBTree<CentralOwnDemand, uint16_t>::iterator it = this->ownDemands.begin(); it != this->ownDemands.end(); ++it) {
+            if(it->slotDemand == 0) {
+                this->ownDemands.remove(it);
+                removed = true;
+                break;
+            }
+        }
+    }
+}
+
+void CentralScheduler::handleStartOfCFP(uint16_t superframe) {
+    if(!this->enabled || superframe != 0) {
+        return;
+    }
+
+    if(this->multiSuperframesSinceReport < 0xFF) {
+        this->multiSuperframesSinceReport++;
+    }
+    if(this->ownDemandsChanged || this->multiSuperframesSinceReport >= CENTRAL_SCHEDULING_REFRESH_INTERVAL) {
+        sendReport();
+    }
+
+    if(this->dsme.getMAC_PIB().macIsPANCoord) {
+        ageDemands();
+
+        if(this->multiSuperframesSincePush < 0xFF) {
+            this->multiSuperframesSincePush++;
+        }
+        if(this->demandsChanged || this->multiSuperframesSincePush >= CENTRAL_SCHEDULING_REFRESH_INTERVAL) {
+            if(this->demandsChanged) {
+                computeSchedule();
+                this->demandsChanged = false;
+            }
+            pushSchedule();
+            this->multiSuperframesSincePush = 0;
+        }
+    }
+}
+
+/*****************************
+ * Reports
+ *****************************/
+
+void CentralScheduler::sendReport() {
+    MAC_PIB& pib = this->dsme.getMAC_PIB();
+    if(!pib.macIsPANCoord && !pib.macAssociatedPANCoord) {
+        return;
+    }
+
+    ScheduleReportCmd report(pib.macShortAddress);
+    NeighborQueue<MAX_NEIGHBORS>& neighborQueue = this->dsme.getMessageDispatcher().getNeighborQueue();
+    LinkQualityTable& linkQuality = this->dsme.getMessageDispatcher().getLinkQualityTable();
+    for(RBTree<CentralOwnDemand, uint16_t>::iterator it = this->ownDemands.begin(); it != this->ownDemands.end(); ++it) {
+        uint16_t destination = it.node()->key;
+
+        uint16_t backlog = 0;
+        NeighborQueue<MAX_NEIGHBORS>::iterator neighbor = neighborQueue.findByAddress(IEEE802154MacAddress(destination));
+        if(neighbor != neighborQueue.end()) {
+            backlog = neighborQueue.getPacketsInQueue(neighbor);
+        }
+
+        report.addLink(ScheduleReportLink{destination, it->slotDemand, (uint8_t)((backlog < 0xFF) ? backlog : 0xFF), linkQuality.getETX(destination)});
+    }
+
+    if(pib.macIsPANCoord) {
+        updateDemands(report);
+    } else if(!sendCommand(report, CommandFrameIdentifier::DSME_SCHEDULE_REPORT, pib.macCoordShortAddress)) {
+        /* '-> retried in the next multi-superframe */
+        return;
+    }
+
+    removeReleasedDemands();
+    this->ownDemandsChanged = false;
+    this->multiSuperframesSinceReport = 0;
+}
+
+void CentralScheduler::handleScheduleReport(IDSMEMessage* msg) {
+    if(!this->enabled) {
+        return;
+    }
+
+    ScheduleReportCmd report;
+    report.decapsulateFrom(msg);
+
+    if(this->dsme.getMAC_PIB().macIsPANCoord) {
+        updateDemands(report);
+    } else if(this->dsme.getMAC_PIB().macAssociatedPANCoord) {
+        /* '-> on the way to the PAN coordinator */
+        sendCommand(report, CommandFrameIdentifier::DSME_SCHEDULE_REPORT, this->dsme.getMAC_PIB().macCoordShortAddress);
+    }
+}
+
+void CentralScheduler::updateDemands(const ScheduleReportCmd& report) {
+    /* only a different set of demands requires a new schedule, the backlog and the ETX only decide the order */
+    uint8_t numPrevious = 0;
+    for(RBTree<CentralLinkDemand, CentralLinkKey>::iterator it = this->demands.begin(); it != this->demands.end(); ++it) {
+        if(it->transmitter == report.getReporter()) {
+            numPrevious++;
+        }
+    }
+    /* links with a demand of 0 are only reported to release their slots */
+    uint8_t numReported = 0;
+    for(uint8_t i = 0; i < report.getNumLinks(); i++) {
+        if(report.getLink(i).slotDemand > 0) {
+            numReported++;
+        }
+    }
+    bool changed = (numPrevious != numReported);
+    for(uint8_t i = 0; i < report.getNumLinks() && !changed; i++) {
+        const ScheduleReportLink& link = report.getLink(i);
+        if(link.slotDemand == 0) {
+            continue;
+        }
+        RBTree<CentralLinkDemand, CentralLinkKey>::iterator it = this->demands.find(CentralLinkKey{report.getReporter(), link.destination});
+        changed = (it == this->demands.end() || it->slotDemand != link.slotDemand);
+    }
+
+    removeDemands(report.getReporter());
+    for(uint8_t i = 0; i < report.getNumLinks(); i++) {
+        const ScheduleReportLink& link = report.getLink(i);
+        if(link.slotDemand == 0) {
+            continue;
+        }
+        if(this->demands.size() >= CENTRAL_SCHEDULING_MAX_LINKS) {
+            LOG_ERROR("Central scheduling: too many links, demand of 0x" << HEXOUT << report.getReporter() << DECOUT << " dropped");
+            break;
+        }
+        CentralLinkDemand demand{report.getReporter(), link.destination, link.slotDemand, link.backlog, link.etx, 0};
+        this->demands.insert(demand, CentralLinkKey{report.getReporter(), link.destination});
+    }
+
+    if(changed) {
+        LOG_INFO("Central scheduling: new demands of 0x" << HEXOUT << report.getReporter() << DECOUT);
+        this->demandsChanged = true;
+    }
+}
+
+void CentralScheduler::removeDemands(uint16_t transmitter) {
+    /* the iterator is invalidated by the removal, so the search starts over after every removal */
+    bool removed = true;
+    while(removed) {
+        removed = false;
+        for(RBTree<CentralLinkDemand, CentralLinkKey>::iterator it = this->demands.begin(); it != this->demands.end(); ++it) {
+            if(it->transmitter == transmitter) {
+                this->demands.remove(it);
+                removed = true;
+                break;
+            }
+        }
+    }
+}
+
+void CentralScheduler::ageDemands() {
+    bool removed = true;
+    while(removed) {
+        removed = false;
+        for(RBTree<CentralLinkDemand, CentralLinkKey>::iterator it = this->demands.begin(); it != this->demands.end(); ++it) {
+            if(it->age >= 3 * CENTRAL_SCHEDULING_REFRESH_INTERVAL) {
+                /* '-> the device did not report for a while, it probably left the network */
+                LOG_INFO("Central scheduling: demands of 0x" << HEXOUT << it->transmitter << DECOUT << " timed out");
+                removeDemands(it->transmitter);
+                this->demandsChanged = true;
+                removed = true;
+                break;
+            }
+        }
+    }
+
+    for(RBTree<CentralLinkDemand, CentralLinkKey>::iterator it = this->demands.begin(); it != this->demands.end(); ++it) {
+        it->age++;
+    }
+}
+
+/*****************************
+ * Schedule computation (PAN coordinator)
+ *****************************/
+
+static uint32_t getWeight(const CentralLinkDemand& demand) {
+    /* expected number of transmissions of the queued frames and the frames of the next multi-superframe */
+    return ((uint32_t)demand.backlog + demand.slotDemand) * demand.etx;
+}
+
+void CentralScheduler::computeSchedule() {
+    /* the links with the highest load are served first, in case the capacity does not suffice for all of them */
+    CentralLinkDemand* order[CENTRAL_SCHEDULING_MAX_LINKS];
+    uint8_t numLinks = 0;
+    for(RBTree<CentralLinkDemand, CentralLinkKey>::iterator it = this->demands.begin(); it != this->demands.end(); ++it) {
+        uint8_t i = numLinks++;
+        while(i > 0 && getWeight(*order[i - 1]) < getWeight(*it)) {
+            order[i] = order[i - 1];
+            i--;
+        }
+        order[i] = &(*it);
+    }
+
+    this->numAllocations = 0;
+    uint16_t numPositions = getNumPositions();
+
+    /* one slot per link and round, so every link gets capacity before any link gets more than it needs */
+    for(uint8_t round = 0;; round++) {
+        bool allocated = false;
+        for(uint8_t i = 0; i < numLinks; i++) {
+            CentralLinkDemand& link = *order[i];
+            if(round >= link.slotDemand) {
+                continue;
+            }
+
+            /* the slots of a link are spread over the multi-superframe, the offset per link keeps the links from starting at the same slot */
+            uint16_t start = ((uint32_t)i * numPositions / numLinks + (uint32_t)round * numPositions / link.slotDemand) % numPositions;
+            if(allocate(link.transmitter, link.receiver, start, numPositions)) {
+                allocated = true;
+            }
+        }
+
+        if(!allocated) {
+            /* '-> all demands are met or the schedule is full */
+            break;
+        }
+    }
+
+    LOG_INFO("Central scheduling: " << this->numAllocations << " allocations for " << (uint16_t)numLinks << " links");
+}
+
+bool CentralScheduler::allocate(uint16_t transmitter, uint16_t receiver, uint16_t start, uint16_t numPositions) {
+    if(this->numAllocations >= CENTRAL_SCHEDULING_MAX_ALLOCATIONS) {
+        return false;
+    }
+
+    uint8_t numChannels = this->dsme.getMAC_PIB().helper.getNumChannels();
+    BitVector<MAX_CHANNELS> usedChannels;
+    usedChannels.setLength(numChannels);
+
+    for(uint16_t i = 0; i < numPositions; i++) {
+        uint8_t superframeID;
+        uint8_t slotID;
+        getSlot((start + i) % numPositions, superframeID, slotID);
+
+        /* a device takes part in at most one link per slot and, without knowledge of the topology, all links of a slot need different channels */
+        usedChannels.fill(false);
+        bool conflict = false;
+        for(uint16_t a = 0; a < this->numAllocations && !conflict; a++) {
+            const ScheduleAllocation& other = this->schedule[a];
+            if(other.superframeID != superframeID || other.slotID != slotID) {
+                continue;
+            }
+            conflict = (other.transmitter == transmitter || other.transmitter == receiver || other.receiver == transmitter || other.receiver == receiver);
+            usedChannels.set(other.channel, true);
+        }
+        if(conflict) {
+            continue;
+        }
+
+        for(uint8_t channel = 0; channel < numChannels; channel++) {
+            if(!usedChannels.get(channel)) {
+                this->schedule[this->numAllocations++] = ScheduleAllocation{transmitter, receiver, superframeID, slotID, channel};
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void CentralScheduler::pushSchedule() {
+    /* every push gets a new version, so the coordinators rebroadcast it exactly once */
+    this->scheduleVersion++;
+
+    /* an empty schedule is pushed as well, so the devices release their slots */
+    uint8_t numFragments = (this->numAllocations + SCHEDULE_PUSH_MAX_ALLOCATIONS - 1) / SCHEDULE_PUSH_MAX_ALLOCATIONS;
+    if(numFragments == 0) {
+        numFragments = 1;
+    }
+
+    for(uint8_t fragment = 0; fragment < numFragments; fragment++) {
+        SchedulePushCmd push(this->scheduleVersion, fragment, numFragments);
+        for(uint16_t a = fragment * SCHEDULE_PUSH_MAX_ALLOCATIONS; a < this->numAllocations && push.addAllocation(this->schedule[a]); a++) {
+        }
+
+        applyPush(push);
+        sendCommand(push, CommandFrameIdentifier::DSME_SCHEDULE_PUSH, IEEE802154MacAddress::SHORT_BROADCAST_ADDRESS);
+    }
+}
+
+/*****************************
+ * Schedule reception
+ *****************************/
+
+void CentralScheduler::handleSchedulePush(IDSMEMessage* msg) {
+    if(!this->enabled || this->dsme.getMAC_PIB().macIsPANCoord) {
+        return;
+    }
+
+    SchedulePushCmd push;
+    push.decapsulateFrom(msg);
+
+    if(applyPush(push) && this->dsme.getMAC_PIB().macIsCoord) {
+        /* '-> first reception of this fragment, pass it on to the devices further away from the PAN coordinator */
+        sendCommand(push, CommandFrameIdentifier::DSME_SCHEDULE_PUSH, IEEE802154MacAddress::SHORT_BROADCAST_ADDRESS);
+    }
+}
+
+bool CentralScheduler::applyPush(const SchedulePushCmd& push) {
+    if(push.getNumFragments() == 0 || push.getNumFragments() > SCHEDULE_PUSH_MAX_FRAGMENTS || push.getFragment() >= push.getNumFragments()) {
+        return false;
+    }
+
+    /* serial number arithmetic on the version, so it may wrap around, but a late fragment of an older schedule is not applied again */
+    int8_t versionDistance = (int8_t)(uint8_t)(push.getVersion() - this->pushVersion);
+    if(this->hasPushVersion && versionDistance < 0) {
+        return false;
+    }
+
+    if(!this->hasPushVersion || versionDistance > 0) {
+        this->hasPushVersion = true;
+        this->pushVersion = push.getVersion();
+        this->receivedFragments = 0;
+        this->pushedSlots.initialize(getNumPositions(), false);
+    }
+
+    uint16_t fragmentBit = 1 << push.getFragment();
+    if(this->receivedFragments & fragmentBit) {
+        return false;
+    }
+    this->receivedFragments |= fragmentBit;
+
+    for(uint8_t i = 0; i < push.getNumAllocations(); i++) {
+        applyAllocation(push.getAllocation(i));
+    }
+
+    if(this->receivedFragments == (uint16_t)((1 << push.getNumFragments()) - 1)) {
+        /* '-> the schedule is complete, so allocations that are not part of it anymore can be released */
+        removeStaleAllocations();
+    }
+    return true;
+}
+
+void CentralScheduler::applyAllocation(const ScheduleAllocation& allocation) {
+    uint16_t ownAddress = this->dsme.getMAC_PIB().macShortAddress;
+    Direction direction;
+    uint16_t partner;
+    if(allocation.transmitter == ownAddress) {
+        direction = Direction::TX;
+        partner = allocation.receiver;
+    } else if(allocation.receiver == ownAddress) {
+        direction = Direction::RX;
+        partner = allocation.transmitter;
+    } else {
+        return;
+    }
+
+    PIBHelper& helper = this->dsme.getMAC_PIB().helper;
+    if(allocation.superframeID >= helper.getNumberSuperframesPerMultiSuperframe() || allocation.slotID >= helper.getNumGTSlots(allocation.superframeID) ||
+       allocation.channel >= helper.getNumChannels()) {
+        LOG_ERROR("Central scheduling: invalid allocation " << (uint16_t)allocation.superframeID << "/" << (uint16_t)allocation.slotID);
+        return;
+    }
+
+    this->pushedSlots.set(getPosition(allocation.superframeID, allocation.slotID), true);
+
+    DSMEAllocationCounterTable& act = this->dsme.getMAC_PIB().macDSMEACT;
+    DSMEAllocationCounterTable::iterator it = act.find(allocation.superframeID, allocation.slotID);
+    if(it != act.end()) {
+        if(it->getAddress() == partner && it->getDirection() == direction && it->getChannel() == allocation.channel) {
+            return;
+        }
+        act.remove(it);
+    }
+
+    if(direction == Direction::TX) {
+        this->dsme.getMessageDispatcher().addNeighbor(IEEE802154MacAddress(partner));
+    }
+    act.add(allocation.superframeID, allocation.slotID, allocation.channel, direction, partner, ACTState::VALID);
+}
+
+void CentralScheduler::removeStaleAllocations() {
+    DSMEAllocationCounterTable& act = this->dsme.getMAC_PIB().macDSMEACT;
+
+    /* the iterator is invalidated by the removal, so the search starts over after every removal */
+    bool removed = true;
+    while(removed) {
+        removed = false;
+        for(DSMEAllocationCounterTable::iterator it = act.begin(); it != act.end(); ++it) {
+            if(!this->pushedSlots.get(getPosition(it->getSuperframeID(), it->getGTSlotID()))) {
+                act.remove(it);
+                removed = true;
+                break;
+            }
+        }
+    }
+}
+
+/*****************************
+ * Helpers
+ *****************************/
+
+bool CentralScheduler::sendCommand(DSMEMessageElement& element, CommandFrameIdentifier commandId, uint16_t dst) {
+    IDSMEMessage* msg = this->dsme.getPlatform().getEmptyMessage();
+    if(msg == nullptr) {
+        return false;
+    }
+
+    element.prependTo(msg);
+
+    MACCommand cmd;
+    cmd.setCmdId(commandId);
+    cmd.prependTo(msg);
+
+    msg->getHeader().setDstAddr(IEEE802154MacAddress(dst));
+    msg->getHeader().setSrcAddrMode(AddrMode::SHORT_ADDRESS);
+    msg->getHeader().setSrcAddr(IEEE802154MacAddress(this->dsme.getMAC_PIB().macShortAddress));
+    msg->getHeader().setDstAddrMode(AddrMode::SHORT_ADDRESS);
+
+    msg->getHeader().setSrcPANId(this->dsme.getMAC_PIB().macPANId);
+    msg->getHeader().setDstPANId(this->dsme.getMAC_PIB().macPANId);
+
+    msg->getHeader().setAckRequest(dst != IEEE802154MacAddress::SHORT_BROADCAST_ADDRESS);
+    msg->getHeader().setFrameType(IEEE802154eMACHeader::FrameType::COMMAND);
+
+    /* STATISTICS (START) */
+    msg->getHeader().setCreationTime(this->dsme.getPlatform().getSymbolCounter());
+    /* STATISTICS (END) */
+
+    if(!this->dsme.getMessageDispatcher().sendInCAP(msg)) {
+        this->dsme.getPlatform().releaseMessage(msg);
+        return false;
+    }
+    return true;
+}
+
+uint16_t CentralScheduler::getNumPositions() const {
+    PIBHelper& helper = this->dsme.getMAC_PIB().helper;
+    return helper.getNumGTSlots(0) + (helper.getNumberSuperframesPerMultiSuperframe() - 1) * helper.getNumGTSlots(1);
+}
+
+uint16_t CentralScheduler::getPosition(uint8_t superframeID, uint8_t slotID) const {
+    PIBHelper& helper = this->dsme.getMAC_PIB().helper;
+    if(superframeID == 0) {
+        return slotID;
+    }
+    return helper.getNumGTSlots(0) + (superframeID - 1) * helper.getNumGTSlots(1) + slotID;
+}
+
+void CentralScheduler::getSlot(uint16_t position, uint8_t& superframeID, uint8_t& slotID) const {
+    PIBHelper& helper = this->dsme.getMAC_PIB().helper;
+    if(position < helper.getNumGTSlots(0)) {
+        superframeID = 0;
+        slotID = position;
+    } else {
+        position -= helper.getNumGTSlots(0);
+        superframeID = 1 + position / helper.getNumGTSlots(1);
+        slotID = position % helper.getNumGTSlots(1);
+    }
+}
+
+} /* namespace dsme */
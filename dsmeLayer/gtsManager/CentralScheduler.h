@@ -0,0 +1,206 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CENTRALSCHEDULER_H_
+#define CENTRALSCHEDULER_H_
+
+#include "../../../dsme_settings.h"
+#include "../../helper/Integers.h"
+#include "../../mac_services/DSME_Common.h"
+#include "../../mac_services/dataStructures/DSMEBitVector.h"
+#include "../../mac_services/dataStructures/RBTree.h"
+#include "../messages/SchedulePushCmd.h"
+#include "../messages/ScheduleReportCmd.h"
+
+/* Maximum number of links the PAN coordinator keeps demands for */
+#ifndef DSME_CENTRAL_SCHEDULING_MAX_LINKS
+#define DSME_CENTRAL_SCHEDULING_MAX_LINKS 64
+#endif
+constexpr uint8_t CENTRAL_SCHEDULING_MAX_LINKS = DSME_CENTRAL_SCHEDULING_MAX_LINKS;
+
+/* Maximum number of allocations in the schedule computed by the PAN coordinator */
+#ifndef DSME_CENTRAL_SCHEDULING_MAX_ALLOCATIONS
+#define DSME_CENTRAL_SCHEDULING_MAX_ALLOCATIONS 64
+#endif
+constexpr uint16_t CENTRAL_SCHEDULING_MAX_ALLOCATIONS = DSME_CENTRAL_SCHEDULING_MAX_ALLOCATIONS;
+static_assert(CENTRAL_SCHEDULING_MAX_ALLOCATIONS <= dsme::SCHEDULE_PUSH_MAX_ALLOCATIONS * dsme::SCHEDULE_PUSH_MAX_FRAGMENTS,
+              "the schedule has to fit into the push commands");
+
+/* Unchanged reports and schedules are repeated after this number of multi-superframes */
+#ifndef DSME_CENTRAL_SCHEDULING_REFRESH_INTERVAL
+#define DSME_CENTRAL_SCHEDULING_REFRESH_INTERVAL 8
+#endif
+constexpr uint8_t CENTRAL_SCHEDULING_REFRESH_INTERVAL = DSME_CENTRAL_SCHEDULING_REFRESH_INTERVAL;
+
+namespace dsme {
+
+class DSMELayer;
+class DSMEMessageElement;
+class IDSMEMessage;
+
+struct CentralLinkKey {
+    uint16_t transmitter;
+    uint16_t receiver;
+
+    bool operator>(const CentralLinkKey& other) const {
+        if(this->transmitter != other.transmitter) {
+            return this->transmitter > other.transmitter;
+        }
+        return this->receiver > other.receiver;
+    }
+
+    bool operator<(const CentralLinkKey& other) const {
+        if(this->transmitter != other.transmitter) {
+            return this->transmitter < other.transmitter;
+        }
+        return this->receiver < other.receiver;
+    }
+
+    bool operator==(const CentralLinkKey& other) const {
+        return ((transmitter == other.transmitter) && (receiver == other.receiver));
+    }
+};
+
+struct CentralLinkDemand {
+    uint16_t transmitter;
+    uint16_t receiver;
+    uint8_t slotDemand;
+    uint8_t backlog;
+    uint16_t etx;
+    uint8_t age; // multi-superframes since the last report of the transmitter
+};
+
+struct CentralOwnDemand {
+    uint8_t slotDemand;
+    bool refreshed; // set by setDemand since the last beginDemands
+};
+
+/*
+ * Optional central scheduling as an alternative to negotiating every GTS with the DSME-GTS handshake.
+ * Every device reports the slot demands of its TX links together with the queue backlog and the ETX towards its coordinator,
+ * the reports are forwarded to the PAN coordinator. The PAN coordinator computes a conflict-free schedule for the whole network
+ * and broadcasts it in batched push commands, which are rebroadcast once by every coordinator.
+ * Has to be enabled on all devices of the PAN.
+ */
+class CentralScheduler {
+public:
+    explicit CentralScheduler(DSMELayer& dsme);
+
+    void reset();
+
+    void setEnabled(bool enabled) {
+        this->enabled = enabled;
+    }
+
+    bool isEnabled() const {
+        return this->enabled;
+    }
+
+    /**
+     * Starts a new set of demands, links that are not set again until endDemands are released.
+     */
+    void beginDemands();
+
+    /**
+     * Sets the number of TX slots required towards a neighbor, e.g. the slot target of the GTS scheduling.
+     * A demand of 0 is reported once, afterwards the link is removed.
+     */
+    void setDemand(uint16_t destination, uint8_t slotDemand);
+
+    /**
+     * Sets the demand of all links to 0 that were not set since beginDemands, e.g. links the GTS scheduling does not know anymore.
+     */
+    void endDemands();
+
+    void handleStartOfCFP(uint16_t superframe);
+
+    void handleScheduleReport(IDSMEMessage* msg);
+
+    void handleSchedulePush(IDSMEMessage* msg);
+
+private:
+    void sendReport();
+    void removeReleasedDemands();
+    void updateDemands(const ScheduleReportCmd& report);
+    void removeDemands(uint16_t transmitter);
+    void ageDemands();
+
+    void computeSchedule();
+    bool allocate(uint16_t transmitter, uint16_t receiver, uint16_t start, uint16_t numPositions);
+    void pushSchedule();
+
+    bool applyPush(const SchedulePushCmd& push);
+    void applyAllocation(const ScheduleAllocation& allocation);
+    void removeStaleAllocations();
+
+    bool sendCommand(DSMEMessageElement& element, CommandFrameIdentifier commandId, uint16_t dst);
+
+    uint16_t getNumPositions() const;
+    uint16_t getPosition(uint8_t superframeID, uint8_t slotID) const;
+    void getSlot(uint16_t position, uint8_t& superframeID, uint8_t& slotID) const;
+
+    DSMELayer& dsme;
+    bool enabled{false};
+
+    /* own TX links, slot demand per destination */
+    RBTree<CentralOwnDemand, uint16_t> ownDemands;
+    bool ownDemandsChanged{false};
+    uint8_t multiSuperframesSinceReport{0};
+
+    /* PAN coordinator only */
+    RBTree<CentralLinkDemand, CentralLinkKey> demands;
+    bool demandsChanged{false};
+    ScheduleAllocation schedule[CENTRAL_SCHEDULING_MAX_ALLOCATIONS];
+    uint16_t numAllocations{0};
+    uint8_t scheduleVersion{0};
+    uint8_t multiSuperframesSincePush{0};
+
+    /* reception of the pushed schedule */
+    bool hasPushVersion{false};
+    uint8_t pushVersion{0};
+    uint16_t receivedFragments{0};
+    BitVector<MAX_SUPERFRAMES_PER_MULTI_SUPERFRAME * MAX_GTSLOTS> pushedSlots; // slots of the own allocations in the pushed schedule
+};
+
+} /* namespace dsme */
+
+#endif /* CENTRALSCHEDULER_H_ */
@@ -51,7 +51,9 @@ GTSData::GTSData()
       cmdToSend(static_cast<CommandFrameIdentifier>(0)),
       msgToSend(nullptr),
       notifyPartnerAddress(IEEE802154MacAddress::NO_SHORT_ADDRESS),
-      responsePartnerAddress(IEEE802154MacAddress::NO_SHORT_ADDRESS) {
+      responsePartnerAddress(IEEE802154MacAddress::NO_SHORT_ADDRESS),
+      claimPartnerAddress(IEEE802154MacAddress::NO_SHORT_ADDRESS),
+      claimRequesting(false) {
 }
 
 } /* namespace dsme */
@@ -67,6 +67,10 @@ public:
 
     uint16_t notifyPartnerAddress;
     uint16_t responsePartnerAddress;
+
+    // Only valid while the FSM is claimed by a negotiation, NO_SHORT_ADDRESS otherwise
+    uint16_t claimPartnerAddress;
+    bool claimRequesting;
 };
 
 } /* namespace dsme */
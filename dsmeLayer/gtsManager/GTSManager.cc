@@ -53,6 +53,7 @@
 #include "../../mac_services/mlme_sap/DSME_GTS.h"
 #include "../../mac_services/pib/MAC_PIB.h"
 #include "../../mac_services/pib/PIBHelper.h"
+#include "../../mac_services/pib/dsme_phy_constants.h"
 #include "../DSMELayer.h"
 #include "../messageDispatcher/MessageDispatcher.h"
 #include "../messages/GTSReplyNotifyCmd.h"
@@ -103,7 +104,19 @@ void GTSEvent::fill(IDSMEMessage* msg, GTSManagement& management, GTSReplyNotify
     this->replyNotifyCmd = replyNotifyCmd;
 }
 
-GTSManager::GTSManager(DSMELayer& dsme) : GTSManagerFSM_t(&GTSManager::stateIdle, &GTSManager::stateBusy), dsme(dsme), actUpdater(dsme) {
+void GTSEvent::fill(GTSManagement& management, GTSReplyNotifyCmd& replyNotifyCmd, CommandFrameIdentifier cmdId, DataStatus::Data_Status dataStatus) {
+    this->deviceAddr = replyNotifyCmd.getDestinationAddress();
+    this->management = management;
+    this->replyNotifyCmd = replyNotifyCmd;
+    this->cmdId = cmdId;
+    this->dataStatus = dataStatus;
+}
+
+GTSManager::GTSManager(DSMELayer& dsme)
+    : GTSManagerFSM_t(&GTSManager::stateIdle, &GTSManager::stateBusy), dsme(dsme), actUpdater(dsme), numIdleFsms(GTS_STATE_MULTIPLICITY) {
+    for(uint8_t i = 0; i < GTS_STATE_MULTIPLICITY; ++i) {
+        idleFsmIds[i] = GTS_STATE_MULTIPLICITY - 1 - i;
+    }
 }
 
 void GTSManager::initialize() {
@@ -118,8 +131,11 @@ void GTSManager::reset() {
     DSME_ATOMIC_BLOCK {
         for(uint8_t i = 0; i < GTS_STATE_MULTIPLICITY; ++i) {
             transition(i, &GTSManager::stateIdle);
+            releaseFsm(i);
             this->data[i].msgToSend = nullptr;
         }
+        this->openNotify = nullptr;
+        this->openNotifyEntries = 0;
     }
 
     this->dsme.getMAC_PIB().macDSMESAB.clear();
@@ -164,6 +180,8 @@ fsmReturnStatus GTSManager::stateIdle(GTSEvent& event) {
 
     switch(event.signal) {
         case GTSEvent::ENTRY_SIGNAL:
+            releaseFsm(fsmId);
+            return FSM_HANDLED;
         case GTSEvent::EXIT_SIGNAL:
             return FSM_IGNORED;
         case GTSEvent::MLME_REQUEST_ISSUED: {
@@ -180,6 +198,7 @@ fsmReturnStatus GTSManager::stateIdle(GTSEvent& event) {
                 data[fsmId].pendingConfirm.status = GTSStatus::TRANSACTION_OVERFLOW;
 
                 this->dsme.getMLME_SAP().getDSME_GTS().notify_confirm(data[fsmId].pendingConfirm);
+                releaseFsm(fsmId);
                 return FSM_HANDLED;
             } else {
                 return transition(fsmId, &GTSManager::stateSending);
@@ -212,6 +231,7 @@ fsmReturnStatus GTSManager::stateIdle(GTSEvent& event) {
                 // TODO also fill other fields
                 params.status = CommStatus::Comm_Status::TRANSACTION_OVERFLOW;
                 this->dsme.getMLME_SAP().getCOMM_STATUS().notify_indication(params);
+                releaseFsm(fsmId);
                 return FSM_HANDLED;
             } else {
                 if(event.management.status == GTSStatus::SUCCESS) {
@@ -228,51 +248,21 @@ fsmReturnStatus GTSManager::stateIdle(GTSEvent& event) {
             return FSM_IGNORED;
 
         case GTSEvent::CFP_STARTED: {
-            // check if a slot should be deallocated, only if no reply or notify is pending
-            for(DSMEAllocationCounterTable::iterator it = dsme.getMAC_PIB().macDSMEACT.begin(); it != dsme.getMAC_PIB().macDSMEACT.end(); ++it) {
-                // Since no reply is pending, this slot should have been removed already and is no longer in the ACT
-                // This should be even the case for timeouts (NO_DATA indication for upper layer)
-                DSME_ASSERT(it->getState() != DEALLOCATED);
-                DSME_ASSERT(it->getState() != REMOVED);
-
-                LOG_DEBUG("check slot " << (uint16_t)it->getGTSlotID() << " " << it->getSuperframeID() << " " << (uint16_t)it->getChannel() << " ["
-                                        << this->dsme.getMAC_PIB().macShortAddress << (const char*)((it->getDirection() == Direction::TX) ? ">" : "<")
-                                        << it->getAddress() << ", " << it->getIdleCounter() << "]");
-
-                // TODO Since INVALID is not included in the standard, use the EXPIRATION type for INVALID, too.
-                //      The effect should be the same.
-                if(it->getState() == INVALID || it->getState() == UNCONFIRMED || it->getIdleCounter() > dsme.getMAC_PIB().macDSMEGTSExpirationTime) {
-                    if(it->getState() == INVALID) {
-                        LOG_INFO("DEALLOCATE: Due to state INVALID");
-                    } else if(it->getState() == UNCONFIRMED) {
-                        if(hasBusyFsm()) {
-                            continue;
-                        }
-                        LOG_INFO("DEALLOCATE: Due to state UNCONFIRMED");
-                    } else if(it->getIdleCounter() > dsme.getMAC_PIB().macDSMEGTSExpirationTime) {
-                        it->resetIdleCounter();
-                        LOG_INFO("DEALLOCATE: Due to expiration");
-                    } else {
-                        DSME_ASSERT(false);
-                    }
-
-                    mlme_sap::DSME_GTS_indication_parameters params;
-                    params.deviceAddress = it->getAddress();
-
-                    params.managementType = EXPIRATION;
-                    params.direction = it->getDirection();
-                    params.prioritizedChannelAccess = Priority::LOW;
-                    params.numSlot = 1;
-
-                    uint8_t subBlockLengthBytes = dsme.getMAC_PIB().helper.getSubBlockLengthBytes(it->getSuperframeID());
-                    params.dsmeSabSpecification.setSubBlockLengthBytes(subBlockLengthBytes);
-                    params.dsmeSabSpecification.setSubBlockIndex(it->getSuperframeID());
-                    params.dsmeSabSpecification.getSubBlock().fill(false);
-                    params.dsmeSabSpecification.getSubBlock().set(it->getGTSlotID() * dsme.getMAC_PIB().helper.getNumChannels() + it->getChannel(), true);
+            if(dsme.getCentralScheduler().isEnabled()) {
+                // the slots are only released by the schedule of the PAN coordinator
+                return FSM_HANDLED;
+            }
 
-                    this->dsme.getMLME_SAP().getDSME_GTS().notify_indication(params);
-                    break;
-                }
+            // check if slots should be deallocated, UNCONFIRMED ones only if no reply or notify is pending
+            // TODO Since INVALID is not included in the standard, use the EXPIRATION type for INVALID, too.
+            //      The effect should be the same.
+            mlme_sap::DSME_GTS_indication_parameters params;
+            params.numSlot = dsme.getMAC_PIB().macDSMEACT.getSlotsToDeallocate(params.dsmeSabSpecification, params.deviceAddress, params.direction,
+                                                                                 !hasBusyFsm());
+            if(params.numSlot > 0) {
+                params.managementType = EXPIRATION;
+                params.prioritizedChannelAccess = Priority::LOW;
+                this->dsme.getMLME_SAP().getDSME_GTS().notify_indication(params);
             }
 
             return FSM_HANDLED;
@@ -453,18 +443,18 @@ fsmReturnStatus GTSManager::stateWaitForResponse(GTSEvent& event) {
 
             if(event.management.status == GTSStatus::SUCCESS) {
                 if(event.management.type == ALLOCATION) {
-                    if(checkAndHandleGTSDuplicateAllocation(event.replyNotifyCmd.getSABSpec(), event.deviceAddr, true)) { // TODO issue #3
-                        uint8_t numSlotsOk = event.replyNotifyCmd.getSABSpec().getSubBlock().count(true);
-
-                        if(numSlotsOk == 0) {
-                            event.management.status = GTSStatus::DENIED;
-                        } else {
-                            DSME_ASSERT(false); /* This case is not handled properly, better use only one slot per request */
-                        }
+                    // Duplicated slots are removed from the SAB specification, the remaining slots of a multi-slot allocation are
+                    // still used (partial approval). The replier deallocates the others after the DUPLICATED_ALLOCATION_NOTIFICATION.
+                    checkAndHandleGTSDuplicateAllocation(event.replyNotifyCmd.getSABSpec(), event.deviceAddr, true); // TODO issue #3
+
+                    if(event.replyNotifyCmd.getSABSpec().getSubBlock().isZero()) {
+                        event.management.status = GTSStatus::DENIED;
                     } else {
                         actUpdater.approvalReceived(event.replyNotifyCmd.getSABSpec(), event.management, event.deviceAddr,
                                                     event.replyNotifyCmd.getChannelOffset());
                     }
+                    params.status = event.management.status;
+                    params.dsmeSabSpecification = event.replyNotifyCmd.getSABSpec();
                 }
             }
 
@@ -679,13 +669,13 @@ void GTSManager::actionReportBusyCommStatus(GTSEvent& event) {
  *****************************/
 
 bool GTSManager::handleMLMERequest(uint16_t deviceAddr, GTSManagement& man, GTSRequestCmd& cmd) {
-    int8_t fsmId = getFsmIdForRequest();
+    int8_t fsmId = getFsmIdForRequest(deviceAddr, man.prioritizedChannelAccess);
     return dispatch(fsmId, GTSEvent::MLME_REQUEST_ISSUED, deviceAddr, man, cmd);
 }
 
 bool GTSManager::handleMLMEResponse(GTSManagement& man, GTSReplyNotifyCmd& reply) {
     uint16_t destinationAddress = reply.getDestinationAddress();
-    int8_t fsmId = getFsmIdForResponse(destinationAddress);
+    int8_t fsmId = getFsmIdForResponse(destinationAddress, man.prioritizedChannelAccess);
     return dispatch(fsmId, GTSEvent::MLME_RESPONSE_ISSUED, destinationAddress, man, reply);
 }
 
@@ -709,7 +699,7 @@ bool GTSManager::handleGTSRequest(IDSMEMessage* msg) {
     params.dsmeSabSpecification = req.getSABSpec();
 
     if(man.type == ManagementType::DUPLICATED_ALLOCATION_NOTIFICATION) {
-        dsme.getMAC_PIB().macDSMESAB.addOccupiedSlots(req.getSABSpec());
+        dsme.getMAC_PIB().macDSMESAB.markOccupiedSlots(req.getSABSpec());
         actUpdater.duplicateAllocation(req.getSABSpec(), 0);
     }
 
@@ -730,13 +720,14 @@ bool GTSManager::handleGTSResponse(IDSMEMessage* msg) {
     } else if(management.status == GTSStatus::SUCCESS) {
         // Response overheared -> Add to the SAB regardless of the current state
         if(management.type == ManagementType::ALLOCATION) {
-            if(!checkAndHandleGTSDuplicateAllocation(replyNotifyCmd.getSABSpec(), msg->getHeader().getSrcAddr().getShortAddress(), false)) {
-                // If there is no conflict, the device shall update macDSMESAB according to the DSMESABSpecification in this
-                // command frame to reflect the neighbor's newly allocated DSME-GTSs
-                this->dsme.getMAC_PIB().macDSMESAB.addOccupiedSlots(replyNotifyCmd.getSABSpec());
-            }
+            // Conflicting slots are removed from the SAB specification, so only the slots without conflict remain.
+            // The device shall update macDSMESAB according to them to reflect the neighbor's newly allocated DSME-GTSs.
+            checkAndHandleGTSDuplicateAllocation(replyNotifyCmd.getSABSpec(), msg->getHeader().getSrcAddr().getShortAddress(), false);
+            this->dsme.getMAC_PIB().macDSMESAB.addOccupiedSlots(replyNotifyCmd.getSABSpec(), msg->getHeader().getSrcAddr().getShortAddress(),
+                                                                replyNotifyCmd.getDestinationAddress());
         } else if(management.type == ManagementType::DEALLOCATION) {
-            this->dsme.getMAC_PIB().macDSMESAB.removeOccupiedSlots(replyNotifyCmd.getSABSpec());
+            this->dsme.getMAC_PIB().macDSMESAB.removeOccupiedSlots(replyNotifyCmd.getSABSpec(), msg->getHeader().getSrcAddr().getShortAddress(),
+                                                                   replyNotifyCmd.getDestinationAddress());
         }
     } else {
         // A denied request should not be sent via broadcast!
@@ -759,6 +750,27 @@ bool GTSManager::handleGTSNotify(IDSMEMessage* msg) {
     GTSReplyNotifyCmd replyNotifyCmd;
     replyNotifyCmd.decapsulateFrom(msg);
 
+    return handleNotify(msg, management, replyNotifyCmd);
+}
+
+bool GTSManager::handleGTSNotifyBundle(IDSMEMessage* msg) {
+    GTSNotifyBundleCmd bundle;
+    bundle.decapsulateFrom(msg);
+
+    bool returnStatus = true;
+    for(uint8_t i = 0; i < bundle.getNumEntries(); i++) {
+        GTSManagement& management = bundle.getManagement(i);
+        if(management.type != ManagementType::ALLOCATION && management.type != ManagementType::DEALLOCATION) {
+            continue;
+        }
+        if(!handleNotify(msg, management, bundle.getNotify(i))) {
+            returnStatus = false;
+        }
+    }
+    return returnStatus;
+}
+
+bool GTSManager::handleNotify(IDSMEMessage* msg, GTSManagement& management, GTSReplyNotifyCmd& replyNotifyCmd) {
     if(replyNotifyCmd.getDestinationAddress() == dsme.getMAC_PIB().macShortAddress) {
         int8_t fsmId = getFsmIdFromNotifyForMe(msg);
         data[fsmId].notifyPartnerAddress = IEEE802154MacAddress::NO_SHORT_ADDRESS;
@@ -766,13 +778,14 @@ bool GTSManager::handleGTSNotify(IDSMEMessage* msg) {
     } else {
         // Notify overheared -> Add to the SAB regardless of the current state
         if(management.type == ManagementType::ALLOCATION) {
-            if(!checkAndHandleGTSDuplicateAllocation(replyNotifyCmd.getSABSpec(), msg->getHeader().getSrcAddr().getShortAddress(), false)) {
-                // If there is no conflict, the device shall update macDSMESAB according to the DSMESABSpecification in this
-                // command frame to reflect the neighbor's newly allocated DSME-GTSs
-                this->dsme.getMAC_PIB().macDSMESAB.addOccupiedSlots(replyNotifyCmd.getSABSpec());
-            }
+            // Conflicting slots are removed from the SAB specification, so only the slots without conflict remain.
+            // The device shall update macDSMESAB according to them to reflect the neighbor's newly allocated DSME-GTSs.
+            checkAndHandleGTSDuplicateAllocation(replyNotifyCmd.getSABSpec(), msg->getHeader().getSrcAddr().getShortAddress(), false);
+            this->dsme.getMAC_PIB().macDSMESAB.addOccupiedSlots(replyNotifyCmd.getSABSpec(), msg->getHeader().getSrcAddr().getShortAddress(),
+                                                                replyNotifyCmd.getDestinationAddress());
         } else if(management.type == ManagementType::DEALLOCATION) {
-            this->dsme.getMAC_PIB().macDSMESAB.removeOccupiedSlots(replyNotifyCmd.getSABSpec());
+            this->dsme.getMAC_PIB().macDSMESAB.removeOccupiedSlots(replyNotifyCmd.getSABSpec(), msg->getHeader().getSrcAddr().getShortAddress(),
+                                                                   replyNotifyCmd.getDestinationAddress());
         }
     }
     return true;
@@ -785,12 +798,8 @@ bool GTSManager::handleStartOfCFP(uint8_t superframe) {
 
     // also execute this during non-idle phases
     if(superframe == 0) {
-        for(DSMEAllocationCounterTable::iterator it = dsme.getMAC_PIB().macDSMEACT.begin(); it != dsme.getMAC_PIB().macDSMEACT.end(); ++it) {
-            if(it->getDirection() == Direction::RX) {
-                // New multi-superframe started, so increment the idle counter according to 5.1.10.5.3
-                it->incrementIdleCounter(); // gets reset to zero on RX
-            }
-        }
+        // New multi-superframe started, so increment the idle counters of the RX slots according to 5.1.10.5.3
+        dsme.getMAC_PIB().macDSMEACT.startMultiSuperframe();
     }
 
     for(uint8_t i = 0; i < GTS_STATE_MULTIPLICITY; ++i) {
@@ -808,6 +817,15 @@ bool GTSManager::handleStartOfCFP(uint8_t superframe) {
 }
 
 bool GTSManager::onCSMASent(IDSMEMessage* msg, CommandFrameIdentifier cmdId, DataStatus::Data_Status status, uint8_t numBackoffs) {
+    if(msg == openNotify) {
+        openNotify = nullptr;
+        openNotifyEntries = 0;
+    }
+
+    if(cmdId == CommandFrameIdentifier::DSME_GTS_NOTIFY_BUNDLE) {
+        return onNotifyBundleSent(msg, status);
+    }
+
     GTSManagement management;
     management.decapsulateFrom(msg);
 
@@ -854,6 +872,115 @@ bool GTSManager::onCSMASent(IDSMEMessage* msg, CommandFrameIdentifier cmdId, Dat
  * Internal helpers
  *****************************/
 
+bool GTSManager::onNotifyBundleSent(IDSMEMessage* msg, DataStatus::Data_Status status) {
+    GTSNotifyBundleCmd bundle;
+    bundle.decapsulateFrom(msg);
+
+    bool returnStatus = true;
+    for(uint8_t i = 0; i < bundle.getNumEntries(); i++) {
+        GTSReplyNotifyCmd& replyNotifyCmd = bundle.getNotify(i);
+
+        // Every entry was sent by the requesting FSM of its destination
+        int8_t validFsmId = -1;
+        for(uint8_t j = 0; j < GTS_STATE_MULTIPLICITY; ++j) {
+            if(data[j].msgToSend == msg && data[j].claimRequesting && data[j].claimPartnerAddress == replyNotifyCmd.getDestinationAddress()) {
+                data[j].msgToSend = nullptr;
+                DSME_ASSERT(getState(j) == &GTSManager::stateSending);
+                validFsmId = j;
+                break;
+            }
+        }
+
+        if(validFsmId >= 0) {
+            if(status != DataStatus::SUCCESS) {
+                LOG_DEBUG("GTSManager::onNotifyBundleSent transmission failure: " << (int16_t)status);
+            }
+            CommandFrameIdentifier cmdId = CommandFrameIdentifier::DSME_GTS_NOTIFY;
+            if(!dispatch(validFsmId, GTSEvent::SEND_COMPLETE, bundle.getManagement(i), replyNotifyCmd, cmdId, status)) {
+                returnStatus = false;
+            }
+        } else {
+            LOG_DEBUG("Outdated message");
+        }
+    }
+
+    dsme.getPlatform().releaseMessage(msg);
+    return returnStatus;
+}
+
+bool GTSManager::coalesceNotify(uint8_t fsmId, IDSMEMessage* msg, GTSManagement& man) {
+    if(!notifyCoalescing || openNotify == nullptr || openNotifyEntries >= GTS_NOTIFY_BUNDLE_MAX_ENTRIES) {
+        return false;
+    }
+    if(man.type != ManagementType::ALLOCATION && man.type != ManagementType::DEALLOCATION) {
+        return false;
+    }
+
+    GTSReplyNotifyCmd replyNotifyCmd;
+    replyNotifyCmd.decapsulateFrom(msg);
+
+    bool coalesced = false;
+    DSME_ATOMIC_BLOCK {
+        if(dsme.getCapLayer().isWaitingForAccess(openNotify)) {
+            /* '-> the open notify is not yet transmitted, so it is rebuilt as a bundle including the new notify */
+            GTSNotifyBundleCmd bundle;
+            MACCommand cmd;
+            cmd.decapsulateFrom(openNotify);
+            if(cmd.getCmdId() == CommandFrameIdentifier::DSME_GTS_NOTIFY) {
+                GTSManagement openManagement;
+                GTSReplyNotifyCmd openReplyNotifyCmd;
+                openManagement.decapsulateFrom(openNotify);
+                openReplyNotifyCmd.decapsulateFrom(openNotify);
+                bundle.addEntry(openManagement, openReplyNotifyCmd);
+            } else {
+                DSME_ASSERT(cmd.getCmdId() == CommandFrameIdentifier::DSME_GTS_NOTIFY_BUNDLE);
+                bundle.decapsulateFrom(openNotify);
+            }
+
+            uint16_t frameLength = openNotify->getHeader().getSerializationLength() + cmd.getSerializationLength() + bundle.getSerializationLength() +
+                                   man.getSerializationLength() + replyNotifyCmd.getSerializationLength() + 2; // FCS
+            if(bundle.getNumEntries() == 1) {
+                frameLength++; // number of entries
+            }
+
+            if(frameLength <= aMaxPHYPacketSize) {
+                coalesced = bundle.addEntry(man, replyNotifyCmd);
+            }
+            prependNotify(openNotify, bundle);
+
+            if(coalesced) {
+                if(man.prioritizedChannelAccess == Priority::HIGH) {
+                    openNotify->trafficClass = TrafficClass::CRITICAL;
+                }
+                openNotifyEntries = bundle.getNumEntries();
+                data[fsmId].cmdToSend = CommandFrameIdentifier::DSME_GTS_NOTIFY;
+                data[fsmId].msgToSend = openNotify;
+            }
+        }
+    }
+
+    if(coalesced) {
+        LOG_INFO("NOTIFY coalesced into bundle of " << (uint16_t)openNotifyEntries);
+        dsme.getPlatform().releaseMessage(msg);
+    } else {
+        replyNotifyCmd.prependTo(msg);
+    }
+    return coalesced;
+}
+
+void GTSManager::prependNotify(IDSMEMessage* msg, GTSNotifyBundleCmd& bundle) {
+    MACCommand cmd;
+    if(bundle.getNumEntries() == 1) {
+        bundle.getNotify(0).prependTo(msg);
+        bundle.getManagement(0).prependTo(msg);
+        cmd.setCmdId(CommandFrameIdentifier::DSME_GTS_NOTIFY);
+    } else {
+        bundle.prependTo(msg);
+        cmd.setCmdId(CommandFrameIdentifier::DSME_GTS_NOTIFY_BUNDLE);
+    }
+    cmd.prependTo(msg);
+}
+
 bool GTSManager::checkAndHandleGTSDuplicateAllocation(DSMESABSpecification& sabSpec, uint16_t addr, bool allChannels) {
     DSMEAllocationCounterTable& macDSMEACT = this->dsme.getMAC_PIB().macDSMEACT;
 
@@ -911,8 +1038,19 @@ bool GTSManager::isTimeoutPending(uint8_t fsmId) {
 }
 
 bool GTSManager::sendGTSCommand(uint8_t fsmId, IDSMEMessage* msg, GTSManagement& man, CommandFrameIdentifier commandId, uint16_t dst, bool reportOnSent) {
+    if(commandId == CommandFrameIdentifier::DSME_GTS_NOTIFY && reportOnSent && coalesceNotify(fsmId, msg, man)) {
+        return true;
+    }
+
     man.prependTo(msg);
 
+    if(man.prioritizedChannelAccess == Priority::HIGH && (man.type == ManagementType::ALLOCATION || man.type == ManagementType::DEALLOCATION)) {
+        /* '-> handled with prioritized channel access in the CAP if enabled */
+        msg->trafficClass = TrafficClass::CRITICAL;
+    } else {
+        msg->trafficClass = TrafficClass::BEST_EFFORT;
+    }
+
     MACCommand cmd;
     cmd.setCmdId(commandId);
     cmd.prependTo(msg);
@@ -942,7 +1080,26 @@ bool GTSManager::sendGTSCommand(uint8_t fsmId, IDSMEMessage* msg, GTSManagement&
     }
 
     numGTSMessages++;
-    return dsme.getMessageDispatcher().sendInCAP(msg);
+    if(commandId == CommandFrameIdentifier::DSME_GTS_REQUEST) {
+        return dsme.getMessageDispatcher().sendInCAP(msg, CAPClass::COMMAND);
+    }
+
+    if(commandId == CommandFrameIdentifier::DSME_GTS_NOTIFY && reportOnSent &&
+       (man.type == ManagementType::ALLOCATION || man.type == ManagementType::DEALLOCATION)) {
+        /* '-> further notifies may be merged into this one as long as it waits for channel access */
+        openNotify = msg;
+        openNotifyEntries = 1;
+    }
+
+    /* '-> replies and notifies complete a pending handshake and are sent first */
+    if(!dsme.getMessageDispatcher().sendInCAP(msg, CAPClass::REPLY)) {
+        if(msg == openNotify) {
+            openNotify = nullptr;
+            openNotifyEntries = 0;
+        }
+        return false;
+    }
+    return true;
 }
 
 void GTSManager::preparePendingConfirm(GTSEvent& event) {
@@ -968,60 +1125,85 @@ void GTSManager::preparePendingConfirm(GTSEvent& event) {
  *****************************/
 
 int8_t GTSManager::getFsmIdIdle() {
-    for(uint8_t i = 0; i < GTS_STATE_MULTIPLICITY; ++i) {
-        if(getState(i) == &GTSManager::stateIdle) {
-            return i;
-        }
+    if(numIdleFsms == 0) {
+        return -1;
     }
-    return -1;
+    return idleFsmIds[numIdleFsms - 1];
 }
 
-int8_t GTSManager::getFsmIdForRequest() {
-    int8_t fsmId = getFsmIdIdle();
-    if(fsmId < 0) {
-        return GTS_STATE_MULTIPLICITY;
-    } else {
-        return fsmId;
-    }
+int8_t GTSManager::getFsmIdForRequest(uint16_t deviceAddress, Priority priority) {
+    return claimFsm(requestingFsms, deviceAddress, true, priority);
 }
 
-int8_t GTSManager::getFsmIdForResponse(uint16_t destinationAddress) {
-    int8_t fsmId = getFsmIdIdle();
-    if(fsmId < 0) {
-        return GTS_STATE_MULTIPLICITY;
-    } else {
-        return fsmId;
-    }
+int8_t GTSManager::getFsmIdForResponse(uint16_t destinationAddress, Priority priority) {
+    return claimFsm(replyingFsms, destinationAddress, false, priority);
 }
 
 int8_t GTSManager::getFsmIdFromResponseForMe(IDSMEMessage* msg) {
     uint16_t srcAddress = msg->getHeader().getSrcAddr().getShortAddress();
-    for(uint8_t i = 0; i < GTS_STATE_MULTIPLICITY; ++i) {
-        if(getState(i) == &GTSManager::stateWaitForResponse && data[i].responsePartnerAddress == srcAddress) {
-            return i;
-        }
+    RBTree<uint8_t, uint16_t>::iterator it = requestingFsms.find(srcAddress);
+    if(it != requestingFsms.end() && getState(*it) == &GTSManager::stateWaitForResponse && data[*it].responsePartnerAddress == srcAddress) {
+        return *it;
     }
     return GTS_STATE_MULTIPLICITY;
 }
 
 int8_t GTSManager::getFsmIdFromNotifyForMe(IDSMEMessage* msg) {
     uint16_t srcAddress = msg->getHeader().getSrcAddr().getShortAddress();
-    for(uint8_t i = 0; i < GTS_STATE_MULTIPLICITY; ++i) {
-        if(getState(i) == &GTSManager::stateWaitForNotify && data[i].notifyPartnerAddress == srcAddress) {
-            return i;
-        }
+    RBTree<uint8_t, uint16_t>::iterator it = replyingFsms.find(srcAddress);
+    if(it != replyingFsms.end() && getState(*it) == &GTSManager::stateWaitForNotify && data[*it].notifyPartnerAddress == srcAddress) {
+        return *it;
     }
     return GTS_STATE_MULTIPLICITY;
 }
 
 bool GTSManager::hasBusyFsm() {
-    bool busyFsm = false;
-    for(uint8_t i = 0; i < GTS_STATE_MULTIPLICITY; ++i) {
-        if(getState(i) != &GTSManager::stateIdle) {
-            busyFsm = true;
-        }
+    return numIdleFsms < GTS_STATE_MULTIPLICITY;
+}
+
+int8_t GTSManager::claimFsm(RBTree<uint8_t, uint16_t>& partnerIndex, uint16_t partnerAddress, bool requesting, Priority priority) {
+    if(numIdleFsms == 0) {
+        return GTS_STATE_MULTIPLICITY;
+    }
+
+    // With prioritized channel access the last idle FSM is kept for negotiations of links with critical traffic
+    if(GTS_STATE_MULTIPLICITY > 1 && numIdleFsms == 1 && priority != Priority::HIGH && dsme.getMAC_PIB().macPriorityChannelAccess) {
+        LOG_INFO("Last GTS FSM reserved for prioritized negotiations");
+        return GTS_STATE_MULTIPLICITY;
+    }
+
+    // A second negotiation with the same partner in the same role could not be told apart on the air
+    if(partnerIndex.find(partnerAddress) != partnerIndex.end()) {
+        LOG_INFO("GTS negotiation with " << partnerAddress << " already pending");
+        return GTS_STATE_MULTIPLICITY;
+    }
+
+    uint8_t fsmId = idleFsmIds[numIdleFsms - 1];
+    DSME_ASSERT(getState(fsmId) == &GTSManager::stateIdle);
+    if(!partnerIndex.insert(fsmId, partnerAddress)) {
+        return GTS_STATE_MULTIPLICITY;
+    }
+    numIdleFsms--;
+
+    data[fsmId].claimPartnerAddress = partnerAddress;
+    data[fsmId].claimRequesting = requesting;
+    return fsmId;
+}
+
+void GTSManager::releaseFsm(int8_t fsmId) {
+    DSME_ASSERT(fsmId >= 0 && fsmId < GTS_STATE_MULTIPLICITY);
+    if(data[fsmId].claimPartnerAddress == IEEE802154MacAddress::NO_SHORT_ADDRESS) {
+        return;
     }
-    return busyFsm;
+
+    RBTree<uint8_t, uint16_t>& partnerIndex = data[fsmId].claimRequesting ? requestingFsms : replyingFsms;
+    RBTree<uint8_t, uint16_t>::iterator it = partnerIndex.find(data[fsmId].claimPartnerAddress);
+    DSME_ASSERT(it != partnerIndex.end() && *it == fsmId);
+    partnerIndex.remove(it);
+    data[fsmId].claimPartnerAddress = IEEE802154MacAddress::NO_SHORT_ADDRESS;
+
+    DSME_ASSERT(numIdleFsms < GTS_STATE_MULTIPLICITY);
+    idleFsmIds[numIdleFsms++] = fsmId;
 }
 
 } /* namespace dsme */
@@ -48,8 +48,10 @@
 #include "../../helper/DSMEFSM.h"
 #include "../../helper/Integers.h"
 #include "../../mac_services/DSME_Common.h"
+#include "../../mac_services/dataStructures/RBTree.h"
 #include "../../mac_services/mlme_sap/DSME_GTS.h"
 #include "../messages/GTSManagement.h"
+#include "../messages/GTSNotifyBundleCmd.h"
 #include "../messages/GTSReplyNotifyCmd.h"
 #include "../messages/GTSRequestCmd.h"
 #include "../messages/IEEE802154eMACHeader.h"
@@ -61,7 +63,12 @@ namespace dsme {
 class IDSMEMessage;
 } /* namespace dsme */
 
-constexpr uint8_t GTS_STATE_MULTIPLICITY = 4;
+/* Number of GTS negotiations that may be pending concurrently, at most one per partner and role */
+#ifndef DSME_GTS_STATE_MULTIPLICITY
+#define DSME_GTS_STATE_MULTIPLICITY 4
+#endif
+constexpr uint8_t GTS_STATE_MULTIPLICITY = DSME_GTS_STATE_MULTIPLICITY;
+static_assert(GTS_STATE_MULTIPLICITY > 0 && GTS_STATE_MULTIPLICITY < 127, "FSM ids (including the busy FSM) have to fit into an int8_t");
 
 namespace dsme {
 
@@ -95,6 +102,8 @@ private:
     void fill(uint16_t& deviceAddr, GTSManagement& management, GTSRequestCmd& requestCmd);
 
     void fill(IDSMEMessage* msg, GTSManagement& management, GTSReplyNotifyCmd& replyNotifyCmd);
+
+    void fill(GTSManagement& management, GTSReplyNotifyCmd& replyNotifyCmd, CommandFrameIdentifier cmdId, DataStatus::Data_Status dataStatus);
 };
 
 class GTSManager;
@@ -164,6 +173,16 @@ public:
      */
     bool handleGTSNotify(IDSMEMessage* msg);
 
+    /**
+     * Update slot allocation on reception of several coalesced GTS Notify commands
+     *
+     * @param msg The received message. Might be modified afterwards (even in case of false),
+     *            but the caller still owns the memory and has to release it.
+     *
+     * @return false if the GTSManager is busy and can not handle one of the notify commands, true otherwise
+     */
+    bool handleGTSNotifyBundle(IDSMEMessage* msg);
+
     /**
      * This shall be called at the start of every CFP.
      *
@@ -186,6 +205,13 @@ public:
      */
     bool onCSMASent(IDSMEMessage* msg, CommandFrameIdentifier cmdId, DataStatus::Data_Status status, uint8_t numBackoffs);
 
+    /**
+     * Enables merging of own GTS Notify commands that wait for channel access into a single frame (not covered by the standard, disabled by default)
+     */
+    void setNotifyCoalescing(bool notifyCoalescing) {
+        this->notifyCoalescing = notifyCoalescing;
+    }
+
     uint32_t numGTSMessages{0};
 
 private:
@@ -210,6 +236,10 @@ private:
      * Internal helper
      */
     bool sendGTSCommand(uint8_t fsmId, IDSMEMessage* msg, GTSManagement& man, CommandFrameIdentifier commandId, uint16_t dst, bool reportOnSent = true);
+    bool coalesceNotify(uint8_t fsmId, IDSMEMessage* msg, GTSManagement& man);
+    void prependNotify(IDSMEMessage* msg, GTSNotifyBundleCmd& bundle);
+    bool handleNotify(IDSMEMessage* msg, GTSManagement& management, GTSReplyNotifyCmd& replyNotifyCmd);
+    bool onNotifyBundleSent(IDSMEMessage* msg, DataStatus::Data_Status status);
     bool checkAndHandleGTSDuplicateAllocation(DSMESABSpecification& sabSpec, uint16_t addr, bool allChannels);
     unsigned getNumAllocatedGTS(bool direction);
     void sendNotify(GTSReplyNotifyCmd& reply, uint16_t sourceAddr, GTSManagement& man);
@@ -223,19 +253,40 @@ private:
      * FSM identification helpers
      */
     int8_t getFsmIdIdle();
-    int8_t getFsmIdForRequest();
-    int8_t getFsmIdForResponse(uint16_t destinationAddress);
+    int8_t getFsmIdForRequest(uint16_t deviceAddress, Priority priority);
+    int8_t getFsmIdForResponse(uint16_t destinationAddress, Priority priority);
     int8_t getFsmIdFromResponseForMe(IDSMEMessage* msg);
     int8_t getFsmIdFromNotifyForMe(IDSMEMessage* msg);
 
     bool hasBusyFsm();
 
+    /**
+     * Takes an idle FSM from the pool and registers it for the given partner.
+     * Returns the busy FSM if none is idle or a negotiation with this partner in this role is already pending.
+     * If prioritized channel access is enabled, the last idle FSM is only handed out for HIGH priority negotiations.
+     */
+    int8_t claimFsm(RBTree<uint8_t, uint16_t>& partnerIndex, uint16_t partnerAddress, bool requesting, Priority priority);
+
+    /**
+     * Returns a claimed FSM to the pool of idle FSMs, does nothing for unclaimed ones.
+     */
+    void releaseFsm(int8_t fsmId);
+
     /*
      * Attributes
      */
     DSMELayer& dsme;
     ACTUpdater actUpdater;
     GTSData data[GTS_STATE_MULTIPLICITY + 1];
+
+    uint8_t idleFsmIds[GTS_STATE_MULTIPLICITY]; // stack of FSMs that are not claimed by any negotiation
+    uint8_t numIdleFsms;
+    RBTree<uint8_t, uint16_t> requestingFsms; // partner address -> FSM of the request sent to it
+    RBTree<uint8_t, uint16_t> replyingFsms;   // partner address -> FSM of the reply sent to it
+
+    bool notifyCoalescing{false};
+    IDSMEMessage* openNotify{nullptr}; // own notify in the CAP queue further notifies may be merged into
+    uint8_t openNotifyEntries{0};
 };
 
 } /* namespace dsme */
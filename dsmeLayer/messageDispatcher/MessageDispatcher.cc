@@ -64,6 +64,7 @@
 #include "../beaconManager/BeaconManager.h"
 #include "../capLayer/CAPLayer.h"
 #include "../gtsManager/GTSManager.h"
+#include "../messages/GroupAckCmd.h"
 #include "../messages/IEEE802154eMACHeader.h"
 #include "../messages/MACCommand.h"
 
@@ -73,11 +74,15 @@ MessageDispatcher::MessageDispatcher(DSMELayer& dsme)
     : dsme(dsme),
       currentACTElement(nullptr, nullptr),
       doneGTS(DELEGATE(&MessageDispatcher::sendDoneGTS, *this)),
+      doneGroupAck(DELEGATE(&MessageDispatcher::sendDoneGroupAck, *this)),
       dsmeAckFrame(nullptr),
       lastSendGTSNeighbor(neighborQueue.end()) {
 }
 
 MessageDispatcher::~MessageDispatcher() {
+    for(uint8_t i = 0; i < this->numGroupAckPending; i++) {
+        this->dsme.getPlatform().releaseMessage(this->groupAckPending[i]);
+    }
     for(NeighborQueue<MAX_NEIGHBORS>::iterator it = neighborQueue.begin(); it != neighborQueue.end(); ++it) {
         while(!this->neighborQueue.isQueueEmpty(it)) {
             IDSMEMessage* msg = neighborQueue.popFront(it);
@@ -93,6 +98,25 @@ void MessageDispatcher::initialize(void) {
 
 void MessageDispatcher::reset(void) {
     currentACTElement = dsme.getMAC_PIB().macDSMEACT.end();
+    linkQualityTable.clear();
+    linkCapacityTable.clear();
+
+    for(uint8_t i = 0; i < this->numGroupAckPending; i++) {
+        mcps_sap::DATA_confirm_parameters params;
+        params.msduHandle = this->groupAckPending[i];
+        params.timestamp = 0;
+        params.rangingReceived = false;
+        params.gtsTX = true;
+        params.status = DataStatus::TRANSACTION_EXPIRED;
+        params.numBackoffs = 0;
+        this->dsme.getMCPS_SAP().getDATA().notify_confirm(params);
+    }
+    this->numGroupAckPending = 0;
+    this->numGroupAckFrames = 0;
+    this->groupAckCandidate = nullptr;
+    this->groupAckRequestPending = false;
+    this->waitingForGroupAck = false;
+    this->groupAckWindow.clear();
 
     for(NeighborQueue<MAX_NEIGHBORS>::iterator it = neighborQueue.begin(); it != neighborQueue.end(); ++it) {
         while(!this->neighborQueue.isQueueEmpty(it)) {
@@ -120,18 +144,49 @@ void MessageDispatcher::sendDoneGTS(enum AckLayerResponse response, IDSMEMessage
     LOG_DEBUG("sendDoneGTS");
 
     DSME_ASSERT(lastSendGTSNeighbor != neighborQueue.end());
-    DSME_ASSERT(msg == neighborQueue.front(lastSendGTSNeighbor));
+    DSME_ASSERT(msg == neighborQueue.front(lastSendGTSNeighbor, msg->trafficClass));
 
     DSMEAllocationCounterTable& act = this->dsme.getMAC_PIB().macDSMEACT;
     DSME_ASSERT(this->currentACTElement != act.end());
 
     this->dsme.getEventDispatcher().setupIFSTimer(msg->getTotalSymbols() > aMaxSIFSFrameSize);
 
+    uint16_t destination = msg->getHeader().getDestAddr().getShortAddress();
+    uint8_t channel = this->dsme.getPlatform().getChannelNumber();
+    if(response == AckLayerResponse::ACK_FAILED || response == AckLayerResponse::ACK_SUCCESSFUL) {
+        this->linkQualityTable.update(destination, channel, response == AckLayerResponse::ACK_SUCCESSFUL, 1);
+    }
+    if(response != AckLayerResponse::SEND_FAILED && response != AckLayerResponse::SEND_ABORTED) {
+        /* '-> the frame was on the air, record how long the attempt occupied the slot until the next frame may be sent */
+        uint8_t ifsSymbols = msg->getTotalSymbols() > aMaxSIFSFrameSize ? const_redefines::macLIFSPeriod : const_redefines::macSIFSPeriod;
+        this->linkCapacityTable.updateAttempt(destination, this->dsme.getPlatform().getSymbolCounter() - this->gtsAttemptStart + ifsSymbols);
+    }
+
+    bool lastOfGroup = isGroupAckActive() && this->groupAckLast;
+
+    if(msg == this->groupAckCandidate) {
+        this->groupAckCandidate = nullptr;
+        msg->getHeader().setAckRequest(true);
+
+        if(response == AckLayerResponse::NO_ACK_REQUESTED) {
+            /* '-> the frame will be confirmed by the group ACK at the end of the transmission */
+            neighborQueue.popFront(lastSendGTSNeighbor, msg->trafficClass);
+            this->preparedMsg = nullptr;
+            DSME_ASSERT(this->numGroupAckPending < GROUP_ACK_WINDOW);
+            this->groupAckPending[this->numGroupAckPending++] = msg;
+
+            continueGTSTransmission(lastOfGroup);
+            return;
+        }
+        /* '-> not transmitted at all, handled like a frame with immediate ACK */
+    }
+
     if(response != AckLayerResponse::NO_ACK_REQUESTED && response != AckLayerResponse::ACK_SUCCESSFUL) {
-        currentACTElement->incrementIdleCounter();
+        this->dsme.getMAC_PIB().macDSMEACT.incrementIdleCounter(currentACTElement);
 
-        // not successful -> retry?
-        if(msg->getRetryCounter() < dsme.getMAC_PIB().macMaxFrameRetries) {
+        // not successful -> retry? (not if the link is hopeless or the deadline would be missed anyway)
+        uint8_t retryBudget = this->linkQualityTable.getRetryBudget(destination, channel, dsme.getMAC_PIB().macMaxFrameRetries);
+        if(msg->getRetryCounter() < retryBudget && !isBeyondDeadline(msg)) {
             msg->increaseRetryCounter();
             //finalizeGTSTransmission();
             LOG_DEBUG("sendDoneGTS - retry");
@@ -143,7 +198,7 @@ void MessageDispatcher::sendDoneGTS(enum AckLayerResponse response, IDSMEMessage
         this->dsme.getPlatform().signalAckedTransmissionResult(response == AckLayerResponse::ACK_SUCCESSFUL, msg->getRetryCounter() + 1, msg->getHeader().getDestAddr());
     }
 
-    neighborQueue.popFront(lastSendGTSNeighbor);
+    neighborQueue.popFront(lastSendGTSNeighbor, msg->trafficClass);
     this->preparedMsg = nullptr;
 
     /* STATISTICS */
@@ -168,13 +223,13 @@ void MessageDispatcher::sendDoneGTS(enum AckLayerResponse response, IDSMEMessage
             break;
         case AckLayerResponse::ACK_FAILED:
             DSME_ASSERT(this->currentACTElement != this->dsme.getMAC_PIB().macDSMEACT.end());
-            currentACTElement->incrementIdleCounter();
+            this->dsme.getMAC_PIB().macDSMEACT.incrementIdleCounter(currentACTElement);
             params.status = DataStatus::NO_ACK;
             break;
         case AckLayerResponse::SEND_FAILED:
             LOG_DEBUG("SEND_FAILED during GTS");
             DSME_ASSERT(this->currentACTElement != this->dsme.getMAC_PIB().macDSMEACT.end());
-            currentACTElement->incrementIdleCounter();
+            this->dsme.getMAC_PIB().macDSMEACT.incrementIdleCounter(currentACTElement);
             params.status = DataStatus::CHANNEL_ACCESS_FAILURE;
             break;
         case AckLayerResponse::SEND_ABORTED:
@@ -188,8 +243,14 @@ void MessageDispatcher::sendDoneGTS(enum AckLayerResponse response, IDSMEMessage
     params.numBackoffs = 0;
     this->dsme.getMCPS_SAP().getDATA().notify_confirm(params);
 
+    continueGTSTransmission(lastOfGroup);
+}
 
-    if(!this->multiplePacketsPerGTS || !prepareNextMessageIfAny()) {
+void MessageDispatcher::continueGTSTransmission(bool lastOfGroup) {
+    if(lastOfGroup && this->numGroupAckPending > 0) {
+        /* '-> the group ACK is requested after the IFS */
+        this->groupAckRequestPending = true;
+    } else if(lastOfGroup || !this->multiplePacketsPerGTS || !prepareNextMessageIfAny()) {
         /* '-> prepare next frame for transmission after one IFS */
         finalizeGTSTransmission();
     }
@@ -199,6 +260,20 @@ void MessageDispatcher::finalizeGTSTransmission() {
     LOG_DEBUG("Finalizing transmission for " << this->currentACTElement->getGTSlotID() << " " << this->currentACTElement->getSuperframeID() << " " << this->currentACTElement->getChannel());
     transceiverOffIfAssociated();
     this->dsme.getEventDispatcher().stopIFSTimer();
+    this->dsme.getAckLayer().discardNextSendingCopy();
+    if(this->numTxGtsFrames > 0 && this->lastSendGTSNeighbor != this->neighborQueue.end() && !this->neighborQueue.isQueueEmpty(this->lastSendGTSNeighbor)) {
+        /* '-> the GTS ended before the queue was empty, so the number of attempts is the capacity of the slot */
+        this->linkCapacityTable.updateSaturatedSlot(this->lastSendGTSNeighbor->address.getShortAddress(),
+                                                    this->numTxGtsFrames < 0xFF ? this->numTxGtsFrames : 0xFF);
+    }
+    if(this->numGroupAckPending > 0) {
+        /* '-> no group ACK received, all frames of the group are missing */
+        resolveGroupAck(GroupAckCmd());
+    }
+    this->numGroupAckFrames = 0;
+    this->groupAckCandidate = nullptr;
+    this->groupAckRequestPending = false;
+    this->waitingForGroupAck = false;
     this->preparedMsg = nullptr;    // TODO correct here?
     this->lastSendGTSNeighbor = this->neighborQueue.end();
     this->currentACTElement = this->dsme.getMAC_PIB().macDSMEACT.end();
@@ -211,6 +286,8 @@ void MessageDispatcher::finalizeGTSTransmission() {
 void MessageDispatcher::onCSMASent(IDSMEMessage* msg, DataStatus::Data_Status status, uint8_t numBackoffs, uint8_t transmissionAttempts) {
     if(status == DataStatus::Data_Status::NO_ACK || status == DataStatus::Data_Status::SUCCESS) {
         if(msg->getHeader().isAckRequested() && !msg->getHeader().getDestAddr().isBroadcast()) {
+            this->linkQualityTable.update(msg->getHeader().getDestAddr().getShortAddress(), this->dsme.getPlatform().getChannelNumber(),
+                                          status == DataStatus::Data_Status::SUCCESS, transmissionAttempts);
             this->dsme.getPlatform().signalAckedTransmissionResult(status == DataStatus::Data_Status::SUCCESS, transmissionAttempts,
                                                                    msg->getHeader().getDestAddr());
         }
@@ -253,8 +330,20 @@ void MessageDispatcher::onCSMASent(IDSMEMessage* msg, DataStatus::Data_Status st
                 case DSME_GTS_REQUEST:
                 case DSME_GTS_REPLY:
                 case DSME_GTS_NOTIFY:
+                case DSME_GTS_NOTIFY_BUNDLE:
                     this->dsme.getGTSManager().onCSMASent(msg, cmd.getCmdId(), status, numBackoffs);
                     break;
+                case DSME_GROUP_ACK:
+                case DSME_GROUP_ACK_REQUEST:
+                    /* only sent during GTS */
+                    DSME_ASSERT(false);
+                    this->dsme.getPlatform().releaseMessage(msg);
+                    break;
+                case DSME_SCHEDULE_REPORT:
+                case DSME_SCHEDULE_PUSH:
+                    /* '-> repeated periodically, so a failure is not handled */
+                    this->dsme.getPlatform().releaseMessage(msg);
+                    break;
             }
         } else {
             this->dsme.getPlatform().releaseMessage(msg);
@@ -269,7 +358,7 @@ bool MessageDispatcher::sendInGTS(IDSMEMessage* msg, NeighborQueue<MAX_NEIGHBORS
 
     numUpperPacketsForGTS++;
 
-    if(!neighborQueue.isQueueFull()) {
+    if(!neighborQueue.isQueueFull(msg->trafficClass)) {
         /* push into queue */
         // TODO implement TRANSACTION_EXPIRED
         uint16_t totalSize = 0;
@@ -277,26 +366,34 @@ bool MessageDispatcher::sendInGTS(IDSMEMessage* msg, NeighborQueue<MAX_NEIGHBORS
             totalSize += it->queueSize;
         }
         LOG_INFO("NeighborQueue is at " << totalSize << "/" << TOTAL_GTS_QUEUE_SIZE << ".");
-        neighborQueue.pushBack(destIt, msg);
+        neighborQueue.pushBack(destIt, msg, msg->trafficClass);
         this->dsme.getPlatform().signalQueueLength(totalSize+1);
         return true;
     } else {
         /* queue full */
-        LOG_INFO("NeighborQueue is full!");
+        LOG_INFO("NeighborQueue is full for traffic class " << (uint16_t)msg->trafficClass << "!");
         numUpperPacketsDroppedFullQueue++;
         return false;
     }
 }
 
 bool MessageDispatcher::sendInCAP(IDSMEMessage* msg) {
-    LOG_INFO("Inserting message into CAP queue.");
+    if(msg->getHeader().getFrameType() == IEEE802154eMACHeader::FrameType::COMMAND) {
+        return sendInCAP(msg, CAPClass::COMMAND);
+    } else {
+        return sendInCAP(msg, CAPClass::forData(msg->trafficClass, msg->hasDeadline));
+    }
+}
+
+bool MessageDispatcher::sendInCAP(IDSMEMessage* msg, CAPClass::CAP_Class capClass) {
+    LOG_INFO("Inserting message into CAP queue of class " << (uint16_t)capClass << ".");
     if(msg->getHeader().getSrcAddrMode() != EXTENDED_ADDRESS && !(this->dsme.getMAC_PIB().macAssociatedPANCoord)) {
         LOG_INFO("Message dropped due to missing association!");
         // TODO document this behaviour
         // TODO send appropriate MCPS confirm or better remove this handling and implement TRANSACTION_EXPIRED
         return false;
     }
-    if(!this->dsme.getCapLayer().pushMessage(msg)) {
+    if(!this->dsme.getCapLayer().pushMessage(msg, capClass)) {
         LOG_INFO("CAP queue full!");
         return false;
     }
@@ -306,6 +403,10 @@ bool MessageDispatcher::sendInCAP(IDSMEMessage* msg) {
     return true;
 }
 
+void MessageDispatcher::setCAPClassLimit(CAPClass::CAP_Class capClass, uint16_t limit) {
+    this->dsme.getCapLayer().setClassLimit(capClass, limit);
+}
+
 void MessageDispatcher::receive(IDSMEMessage* msg) {
     IEEE802154eMACHeader macHdr = msg->getHeader();
 
@@ -333,6 +434,10 @@ void MessageDispatcher::receive(IDSMEMessage* msg) {
                     LOG_INFO("DSME-GTS-NOTIFY from " << macHdr.getSrcAddr().getShortAddress() << ".");
                     dsme.getGTSManager().handleGTSNotify(msg);
                     break;
+                case CommandFrameIdentifier::DSME_GTS_NOTIFY_BUNDLE:
+                    LOG_INFO("DSME-GTS-NOTIFY-BUNDLE from " << macHdr.getSrcAddr().getShortAddress() << ".");
+                    dsme.getGTSManager().handleGTSNotifyBundle(msg);
+                    break;
                 case CommandFrameIdentifier::ASSOCIATION_REQUEST:
                     LOG_INFO("ASSOCIATION-REQUEST from " << macHdr.getSrcAddr().getShortAddress() << ".");
                     dsme.getAssociationManager().handleAssociationRequest(msg);
@@ -348,6 +453,22 @@ void MessageDispatcher::receive(IDSMEMessage* msg) {
                 case CommandFrameIdentifier::DATA_REQUEST:
                     /* Not implemented */
                     break;
+                case CommandFrameIdentifier::DSME_GROUP_ACK:
+                    LOG_INFO("DSME-GROUP-ACK from " << macHdr.getSrcAddr().getShortAddress() << ".");
+                    handleGroupAck(msg);
+                    break;
+                case CommandFrameIdentifier::DSME_GROUP_ACK_REQUEST:
+                    LOG_INFO("DSME-GROUP-ACK-REQUEST from " << macHdr.getSrcAddr().getShortAddress() << ".");
+                    handleGroupAckRequest(msg);
+                    break;
+                case CommandFrameIdentifier::DSME_SCHEDULE_REPORT:
+                    LOG_INFO("DSME-SCHEDULE-REPORT from " << macHdr.getSrcAddr().getShortAddress() << ".");
+                    dsme.getCentralScheduler().handleScheduleReport(msg);
+                    break;
+                case CommandFrameIdentifier::DSME_SCHEDULE_PUSH:
+                    LOG_INFO("DSME-SCHEDULE-PUSH from " << macHdr.getSrcAddr().getShortAddress() << ".");
+                    dsme.getCentralScheduler().handleSchedulePush(msg);
+                    break;
                 case CommandFrameIdentifier::DSME_BEACON_ALLOCATION_NOTIFICATION:
                     LOG_INFO("DSME-BEACON-ALLOCATION-NOTIFICATION from " << macHdr.getSrcAddr().getShortAddress() << ".");
                     dsme.getBeaconManager().handleBeaconAllocation(msg);
@@ -392,6 +513,9 @@ bool MessageDispatcher::handlePreSlotEvent(uint8_t nextSlot, uint8_t nextSuperfr
     if(this->currentACTElement != act.end()) {
         if(this->currentACTElement->getDirection() == Direction::RX) {
             this->currentACTElement = act.end();
+        } else if(this->waitingForGroupAck || this->groupAckRequestPending) {
+            /* '-> the group ACK did not arrive in time, all frames of the group will be retransmitted */
+            finalizeGTSTransmission();
         } else {
             // Rarely happens, only if the sendDoneGTS is delayed
             // Then skip this preSlotEvent
@@ -416,7 +540,12 @@ bool MessageDispatcher::handlePreSlotEvent(uint8_t nextSlot, uint8_t nextSuperfr
 
             // For RX also if INVALID or UNCONFIRMED!
             if((this->currentACTElement->getState() == VALID) || (this->currentACTElement->getDirection() == Direction::RX)) {
-                this->dsme.getPlatform().turnTransceiverOn();
+                if(this->currentACTElement->getDirection() == Direction::RX) {
+                    /* '-> the sender's slot timing is as uncertain as the own one */
+                    this->dsme.startReceptionInNextSlot(2 * this->dsme.getBeaconManager().getRxGuardTime());
+                } else {
+                    this->dsme.getPlatform().turnTransceiverOn();
+                }
 
                 if(dsme.getMAC_PIB().macChannelDiversityMode == Channel_Diversity_Mode::CHANNEL_ADAPTATION) {
                     this->dsme.getPlatform().setChannelNumber(this->dsme.getMAC_PIB().helper.getChannels()[this->currentACTElement->getChannel()]);
@@ -486,7 +615,12 @@ bool MessageDispatcher::handleIFSEvent(int32_t lateness) {
     DSME_ASSERT(this->currentACTElement->getSuperframeID() == this->dsme.getCurrentSuperframe() && this->currentACTElement->getGTSlotID()
       == this->dsme.getCurrentSlot() - (this->dsme.getMAC_PIB().helper.getFinalCAPSlot(this->dsme.getCurrentSuperframe())+1));
 
-    if(!sendPreparedMessage()) {
+    if(this->groupAckRequestPending) {
+        /* '-> keep listening for the group ACK until it arrives or the slot ends */
+        this->groupAckRequestPending = false;
+        this->waitingForGroupAck = true;
+        sendGroupAckRequest();
+    } else if(!sendPreparedMessage()) {
         finalizeGTSTransmission();
     }
 
@@ -551,6 +685,19 @@ void MessageDispatcher::handleGTSFrame(IDSMEMessage* msg) {
        currentACTElement->getGTSlotID() == dsme.getCurrentSlot() - (dsme.getMAC_PIB().helper.getFinalCAPSlot(dsme.getCurrentSuperframe()) + 1)) {
         // According to 5.1.10.5.3
         currentACTElement->resetIdleCounter();
+
+        /* the GTSs of a link recur at least once per multi-superframe, older entries of the window are not comparable anymore */
+        const PIBHelper& helper = this->dsme.getMAC_PIB().helper;
+        const uint32_t symbolsPerMultiSuperframe = helper.getSymbolsPerSlot() * aNumSuperframeSlots * helper.getNumberSuperframesPerMultiSuperframe();
+
+        IEEE802154eMACHeader& header = msg->getHeader();
+        if(isGroupAckActive() && !this->groupAckWindow.record(header.getSrcAddr().getShortAddress(), header.getSequenceNumber(),
+                                                              msg->getStartOfFrameDelimiterSymbolCounter(), symbolsPerMultiSuperframe)) {
+            /* '-> retransmission of a frame that was already delivered, but its group ACK was lost */
+            LOG_DEBUG("Duplicate frame " << (uint16_t)header.getSequenceNumber() << " from " << header.getSrcAddr().getShortAddress());
+            this->dsme.getPlatform().releaseMessage(msg);
+            return;
+        }
     }
 
     createDataIndication(msg);
@@ -565,22 +712,24 @@ bool MessageDispatcher::prepareNextMessageIfAny() {
     bool result = false;
     bool checkTimeToSendMessage = false;
 
+    // a pending message that can not meet its deadline anymore is dropped
+    if(this->preparedMsg && isBeyondDeadline(this->preparedMsg)) {
+        dropExpiredMessage(this->preparedMsg);
+        this->preparedMsg = nullptr;
+    }
+
     // check if there exists a pending Message
     if(this->preparedMsg) {
         checkTimeToSendMessage = true; // if true, set a flag to to check if pending message can be sent in remaining slot time
-    } else if (this->neighborQueue.isQueueEmpty(this->lastSendGTSNeighbor)) {  // there is no pending message, then check if the queue is empty (i.e. there is not any message to transmit to a target neighbor)
-        this->preparedMsg = nullptr; // reset value of pending Message
-        checkTimeToSendMessage = false;
-        result = false;
-    } else { // if there is a message to send retrieve a copy of it from the queue and set the flag to check if possible to send the message
-        checkTimeToSendMessage = true;
-        this->preparedMsg = neighborQueue.front(this->lastSendGTSNeighbor);
+    } else {
+        // otherwise select the next message from the queue of the neighbor (if any) and set the flag to check if possible to send the message
+        this->preparedMsg = selectNextMessage();
+        checkTimeToSendMessage = (this->preparedMsg != nullptr);
     }
 
     if(checkTimeToSendMessage) {//if the timming for transmission must be checked
         // determined how long the transmission of the preparedMessage will take.
-        uint8_t ifsSymbols = this->preparedMsg->getTotalSymbols() <= aMaxSIFSFrameSize ? const_redefines::macSIFSPeriod : const_redefines::macLIFSPeriod;
-        uint32_t duration = this->preparedMsg->getTotalSymbols() + this->dsme.getMAC_PIB().helper.getAckWaitDuration() + ifsSymbols;
+        uint32_t duration = getGTSTransmissionDuration(this->preparedMsg);
         // check if the remaining slot time is enough to transmit the prepared packet
         if(!this->dsme.isWithinTimeSlot(this->dsme.getPlatform().getSymbolCounter(), duration)) {
             LOG_DEBUG("No packet prepared (remaining slot time insufficient)");
@@ -597,16 +746,26 @@ bool MessageDispatcher::sendPreparedMessage() {
     DSME_ASSERT(this->preparedMsg);
     DSME_ASSERT(this->dsme.getMAC_PIB().helper.getSymbolsPerSlot() >= this->preparedMsg->getTotalSymbols() + this->dsme.getMAC_PIB().helper.getAckWaitDuration() + 10 /* arbitrary processing delay */ + PRE_EVENT_SHIFT);
 
-    uint8_t ifsSymbols = this->preparedMsg->getTotalSymbols() <= aMaxSIFSFrameSize ? const_redefines::macSIFSPeriod : const_redefines::macLIFSPeriod;
-    uint32_t duration = this->preparedMsg->getTotalSymbols() + this->dsme.getMAC_PIB().helper.getAckWaitDuration() + ifsSymbols;
+    uint32_t duration = getGTSTransmissionDuration(this->preparedMsg);
     /* '-> Duration for the transmission of the next frame */
 
     if(this->dsme.isWithinTimeSlot(this->dsme.getPlatform().getSymbolCounter(), duration)) {
         /* '-> Sufficient time to send message in remaining slot time */
-        if (this->dsme.getAckLayer().prepareSendingCopy(this->preparedMsg, this->doneGTS)) {
+        IDSMEMessage* msg = this->preparedMsg;
+        if(isGroupAckActive()) {
+            prepareGroupAckTransmission(msg);
+        }
+        if (this->dsme.getAckLayer().prepareSendingCopy(msg, this->doneGTS)) {
             /* '-> Message transmission can be attempted */
+            this->gtsAttemptStart = this->dsme.getPlatform().getSymbolCounter();
             this->dsme.getAckLayer().sendNowIfPending();
             this->numTxGtsFrames++;
+
+            /* with group ACKs the header of the following message depends on the remaining slot time when it is sent */
+            if(this->multiplePacketsPerGTS && !this->groupAck && this->preparedMsg == msg) {
+                /* '-> serialize the following message while waiting for the ACK */
+                prepareFollowingMessage(msg);
+            }
         } else {
             /* '-> Message could not be sent via ACKLayer (FAILED) */
             sendDoneGTS(AckLayerResponse::SEND_FAILED, this->preparedMsg);
@@ -617,6 +776,269 @@ bool MessageDispatcher::sendPreparedMessage() {
     return false;
 }
 
+uint32_t MessageDispatcher::getGTSTransmissionDuration(IDSMEMessage* msg) {
+    uint8_t ifsSymbols = msg->getTotalSymbols() <= aMaxSIFSFrameSize ? const_redefines::macSIFSPeriod : const_redefines::macLIFSPeriod;
+
+    /* with group ACKs every frame might be the last one of the GTS, so it has to leave room for the group ACK */
+    uint32_t ackSymbols = isGroupAckActive() ? getGroupAckWaitDuration() : this->dsme.getMAC_PIB().helper.getAckWaitDuration();
+    return msg->getTotalSymbols() + ackSymbols + ifsSymbols;
+}
+
+uint32_t MessageDispatcher::getGroupAckWaitDuration() {
+    /* the ACK wait duration covers 6 octets (PHR, frame control, sequence number and FCS), the group ACK additionally carries
+     * the PAN ID, both short addresses, the command ID and the GroupAckCmd */
+    const uint8_t additionalOctets = 2 + 2 + 2 + 1 + 3;
+
+    /* it is preceded by the group ACK request (the same header and the GroupAckRequestCmd) and its turnaround */
+    const uint8_t requestOctets = 6 + 2 + 2 + 2 + 1 + 1;
+    return this->dsme.getMAC_PIB().helper.getAckWaitDuration() + (additionalOctets + requestOctets) * this->dsme.getPHY_PIB().phySymbolsPerOctet +
+           const_redefines::macSIFSPeriod;
+}
+
+int32_t MessageDispatcher::getSlack(IDSMEMessage* msg) {
+    DSME_ASSERT(msg->hasDeadline);
+    return (int32_t)(msg->deadline - this->dsme.getPlatform().getSymbolCounter()) - (int32_t)getGTSTransmissionDuration(msg);
+}
+
+bool MessageDispatcher::isBeyondDeadline(IDSMEMessage* msg) {
+    return msg->hasDeadline && getSlack(msg) < 0;
+}
+
+void MessageDispatcher::prepareFollowingMessage(IDSMEMessage* currentMsg) {
+    IDSMEMessage* next = selectNextMessage(currentMsg);
+    if(next == nullptr) {
+        return;
+    }
+
+    uint32_t duration = getGTSTransmissionDuration(currentMsg) + getGTSTransmissionDuration(next);
+    if(this->dsme.isWithinTimeSlot(this->dsme.getPlatform().getSymbolCounter(), duration)) {
+        this->dsme.getAckLayer().prepareNextSendingCopy(next);
+    }
+}
+
+IDSMEMessage* MessageDispatcher::selectNextMessage(IDSMEMessage* exclude) {
+    const PIBHelper& helper = this->dsme.getMAC_PIB().helper;
+    const int32_t symbolsPerMultiSuperframe = helper.getSymbolsPerSlot() * aNumSuperframeSlots * helper.getNumberSuperframesPerMultiSuperframe();
+
+    IDSMEMessage* next = nullptr;
+    IDSMEMessage* urgent = nullptr;
+    int32_t urgentSlack = symbolsPerMultiSuperframe;
+
+    for(uint8_t trafficClass = 0; trafficClass < NUM_TRAFFIC_CLASSES; trafficClass++) {
+        IDSMEMessage* msg = this->neighborQueue.front(this->lastSendGTSNeighbor, trafficClass);
+
+        if(exclude == nullptr) {
+            /* drop all messages at the front that can not meet their deadline anymore */
+            while(msg != nullptr && isBeyondDeadline(msg)) {
+                dropExpiredMessage(msg);
+                msg = this->neighborQueue.front(this->lastSendGTSNeighbor, trafficClass);
+            }
+        } else {
+            /* look ahead only, expired messages are dropped on the actual selection */
+            if(msg == exclude) {
+                msg = this->neighborQueue.second(this->lastSendGTSNeighbor, trafficClass);
+            }
+            if(msg != nullptr && isBeyondDeadline(msg)) {
+                continue;
+            }
+        }
+
+        if(msg == nullptr) {
+            continue;
+        }
+
+        if(next == nullptr) {
+            /* '-> strict priority among the traffic classes */
+            next = msg;
+        }
+
+        if(msg->hasDeadline) {
+            /* '-> messages that would probably miss their deadline while waiting for the next multi-superframe are served earliest deadline first */
+            int32_t slack = getSlack(msg);
+            if(slack < urgentSlack) {
+                urgentSlack = slack;
+                urgent = msg;
+            }
+        }
+    }
+
+    return (urgent != nullptr) ? urgent : next;
+}
+
+void MessageDispatcher::dropExpiredMessage(IDSMEMessage* msg) {
+    DSME_ASSERT(msg == this->neighborQueue.front(this->lastSendGTSNeighbor, msg->trafficClass));
+    LOG_DEBUG("Dropping message for " << msg->getHeader().getDestAddr().getShortAddress() << ", deadline missed");
+
+    this->dsme.getAckLayer().discardNextSendingCopy(msg);
+    this->neighborQueue.popFront(this->lastSendGTSNeighbor, msg->trafficClass);
+    this->numDeadlineMisses++;
+
+    mcps_sap::DATA_confirm_parameters params;
+    params.msduHandle = msg;
+    params.timestamp = 0;
+    params.rangingReceived = false;
+    params.gtsTX = true;
+    params.status = DataStatus::TRANSACTION_EXPIRED;
+    params.numBackoffs = 0;
+    this->dsme.getMCPS_SAP().getDATA().notify_confirm(params);
+}
+
+void MessageDispatcher::prepareGroupAckTransmission(IDSMEMessage* msg) {
+    /* the group ACK can only acknowledge sequence numbers within its window, every transmission consumes one */
+    this->numGroupAckFrames++;
+
+    IDSMEMessage* next = selectNextMessage(msg);
+    this->groupAckLast = (this->numGroupAckFrames >= GROUP_ACK_WINDOW) || (next == nullptr) ||
+                         !this->dsme.isWithinTimeSlot(this->dsme.getPlatform().getSymbolCounter(), getGTSTransmissionDuration(msg) + getGTSTransmissionDuration(next));
+
+    /* retransmissions keep their sequence number, new frames get the next one from the AckLayer */
+    uint8_t sequenceNumber = msg->getRetryCounter() > 0 ? msg->getHeader().getSequenceNumber() : this->dsme.getMAC_PIB().macDsn;
+    bool withinWindow = this->numGroupAckPending == 0 ||
+                        (uint8_t)(sequenceNumber - this->groupAckPending[0]->getHeader().getSequenceNumber()) < GROUP_ACK_WINDOW;
+
+    if(msg->getHeader().isAckRequested() && withinWindow) {
+        /* '-> acknowledged by the group ACK instead */
+        msg->getHeader().setAckRequest(false);
+        this->groupAckCandidate = msg;
+    } else {
+        this->groupAckCandidate = nullptr;
+    }
+}
+
+void MessageDispatcher::resolveGroupAck(const GroupAckCmd& ack) {
+    DSME_ASSERT(this->lastSendGTSNeighbor != this->neighborQueue.end());
+    DSME_ASSERT(this->currentACTElement != this->dsme.getMAC_PIB().macDSMEACT.end());
+
+    uint8_t channel = this->dsme.getPlatform().getChannelNumber();
+    bool anyAcknowledged = false;
+
+    /* in reverse order, so the retransmissions are queued in their original order */
+    for(int8_t i = this->numGroupAckPending - 1; i >= 0; i--) {
+        IDSMEMessage* msg = this->groupAckPending[i];
+        uint16_t destination = msg->getHeader().getDestAddr().getShortAddress();
+        bool acknowledged = ack.isAcknowledged(msg->getHeader().getSequenceNumber());
+
+        this->linkQualityTable.update(destination, channel, acknowledged, 1);
+
+        if(acknowledged) {
+            anyAcknowledged = true;
+        } else {
+            uint8_t retryBudget = this->linkQualityTable.getRetryBudget(destination, channel, dsme.getMAC_PIB().macMaxFrameRetries);
+            if(msg->getRetryCounter() < retryBudget && !isBeyondDeadline(msg) && !this->neighborQueue.isQueueFull()) {
+                /* '-> only the missing frame is retransmitted, it is the next one sent to this neighbor */
+                msg->increaseRetryCounter();
+                this->neighborQueue.pushFront(this->lastSendGTSNeighbor, msg, msg->trafficClass);
+                continue;
+            }
+        }
+
+        this->dsme.getPlatform().signalAckedTransmissionResult(acknowledged, msg->getRetryCounter() + 1, msg->getHeader().getDestAddr());
+
+        mcps_sap::DATA_confirm_parameters params;
+        params.msduHandle = msg;
+        params.timestamp = 0; // TODO
+        params.rangingReceived = false;
+        params.gtsTX = true;
+        params.status = acknowledged ? DataStatus::SUCCESS : DataStatus::NO_ACK;
+        params.numBackoffs = 0;
+        this->dsme.getMCPS_SAP().getDATA().notify_confirm(params);
+    }
+    this->numGroupAckPending = 0;
+
+    if(!anyAcknowledged) {
+        this->dsme.getMAC_PIB().macDSMEACT.incrementIdleCounter(currentACTElement);
+    }
+}
+
+void MessageDispatcher::handleGroupAck(IDSMEMessage* msg) {
+    if(!this->waitingForGroupAck || this->lastSendGTSNeighbor == this->neighborQueue.end() ||
+       msg->getHeader().getSrcAddr().getShortAddress() != this->lastSendGTSNeighbor->address.getShortAddress()) {
+        /* '-> not expected (anymore), e.g. received after the end of the slot */
+        return;
+    }
+
+    GroupAckCmd ack;
+    ack.decapsulateFrom(msg);
+    resolveGroupAck(ack);
+    finalizeGTSTransmission();
+}
+
+void MessageDispatcher::sendGroupAckRequest() {
+    DSME_ASSERT(this->lastSendGTSNeighbor != this->neighborQueue.end());
+    DSME_ASSERT(this->numGroupAckPending > 0);
+
+    IDSMEMessage* msg = this->dsme.getPlatform().getEmptyMessage();
+    if(msg == nullptr) {
+        /* '-> the pending frames are resolved as not acknowledged at the end of the slot */
+        return;
+    }
+
+    GroupAckRequestCmd request(this->groupAckPending[0]->getHeader().getSequenceNumber());
+    request.prependTo(msg);
+
+    MACCommand cmd;
+    cmd.setCmdId(CommandFrameIdentifier::DSME_GROUP_ACK_REQUEST);
+    cmd.prependTo(msg);
+
+    prepareGroupAckHeader(msg, this->lastSendGTSNeighbor->address.getShortAddress());
+
+    if(this->dsme.getAckLayer().prepareSendingCopy(msg, this->doneGroupAck)) {
+        this->dsme.getAckLayer().sendNowIfPending();
+    } else {
+        this->dsme.getPlatform().releaseMessage(msg);
+    }
+}
+
+void MessageDispatcher::handleGroupAckRequest(IDSMEMessage* msg) {
+    if(!isGroupAckActive() || this->currentACTElement == this->dsme.getMAC_PIB().macDSMEACT.end() ||
+       this->currentACTElement->getDirection() != Direction::RX ||
+       msg->getHeader().getSrcAddr().getShortAddress() != this->currentACTElement->getAddress()) {
+        /* '-> only answered during a receiving GTS of the link to the requesting device, not if overheard */
+        return;
+    }
+
+    GroupAckRequestCmd request;
+    request.decapsulateFrom(msg);
+    sendGroupAck(msg->getHeader().getSrcAddr().getShortAddress(), request.getBaseSequenceNumber());
+}
+
+void MessageDispatcher::sendGroupAck(uint16_t destination, uint8_t baseSequenceNumber) {
+    IDSMEMessage* msg = this->dsme.getPlatform().getEmptyMessage();
+    if(msg == nullptr) {
+        return;
+    }
+
+    GroupAckCmd ack(baseSequenceNumber, this->groupAckWindow.getBitmap(destination, baseSequenceNumber, GROUP_ACK_WINDOW));
+    ack.prependTo(msg);
+
+    MACCommand cmd;
+    cmd.setCmdId(CommandFrameIdentifier::DSME_GROUP_ACK);
+    cmd.prependTo(msg);
+
+    prepareGroupAckHeader(msg, destination);
+
+    if(this->dsme.getAckLayer().prepareSendingCopy(msg, this->doneGroupAck)) {
+        this->dsme.getAckLayer().sendNowIfPending();
+    } else {
+        this->dsme.getPlatform().releaseMessage(msg);
+    }
+}
+
+void MessageDispatcher::prepareGroupAckHeader(IDSMEMessage* msg, uint16_t destination) {
+    msg->getHeader().setDstAddr(IEEE802154MacAddress(destination));
+    msg->getHeader().setSrcAddrMode(AddrMode::SHORT_ADDRESS);
+    msg->getHeader().setSrcAddr(IEEE802154MacAddress(this->dsme.getMAC_PIB().macShortAddress));
+    msg->getHeader().setDstAddrMode(AddrMode::SHORT_ADDRESS);
+    msg->getHeader().setSrcPANId(this->dsme.getMAC_PIB().macPANId);
+    msg->getHeader().setDstPANId(this->dsme.getMAC_PIB().macPANId);
+    msg->getHeader().setAckRequest(false);
+    msg->getHeader().setFrameType(IEEE802154eMACHeader::FrameType::COMMAND);
+}
+
+void MessageDispatcher::sendDoneGroupAck(enum AckLayerResponse /* response */, IDSMEMessage* msg) {
+    /* '-> a lost group ACK is not repeated, the sender retransmits the frames that are not acknowledged */
+    this->dsme.getPlatform().releaseMessage(msg);
+}
 
 void MessageDispatcher::createDataIndication(IDSMEMessage* msg) {
     IEEE802154eMACHeader& header = msg->getHeader();
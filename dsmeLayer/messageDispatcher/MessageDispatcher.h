@@ -46,7 +46,11 @@
 #include "../../../dsme_platform.h"
 #include "../../helper/Integers.h"
 #include "../../mac_services/dataStructures/DSMEAllocationCounterTable.h"
+#include "../../mac_services/dataStructures/GroupAckWindow.h"
+#include "../../mac_services/dataStructures/LinkCapacityTable.h"
+#include "../../mac_services/dataStructures/LinkQualityTable.h"
 #include "../ackLayer/AckLayer.h"
+#include "../messages/GroupAckCmd.h"
 #include "../neighbors/NeighborQueue.h"
 
 namespace dsme {
@@ -64,23 +68,41 @@ public:
 private:
     DSMELayer& dsme;
     bool multiplePacketsPerGTS{false};
+    bool groupAck{false};
 
 public:
-    /*! Queues a message for transmission during a GTS.
+    /*! Queues a message for transmission during a GTS in the queue of its traffic class.
      *
      * \param msg The message to transmit
      * \param destIt The destination device
-     * \return false if the GTS queue is full, true otherwise
+     * \return false if the GTS queue is full for the traffic class of the message, true otherwise
      */
     bool sendInGTS(IDSMEMessage* msg, NeighborQueue<MAX_NEIGHBORS>::iterator destIt);
 
     /*! Queues a message for transmission during the CAP.
+     *  MAC commands are queued as CAPClass::COMMAND, critical event messages and frames of the critical traffic class
+     *  as CAPClass::CRITICAL_DATA, all other frames as CAPClass::DATA.
      *
      * \param msg The message to transmit
      * \return true if the message was pushed to the #CAPLayer, false otherwise
      */
     bool sendInCAP(IDSMEMessage* msg);
 
+    /*! Queues a message for transmission during the CAP in the queue of the given class.
+     *
+     * \param msg The message to transmit
+     * \param capClass The class of the message, lower classes are sent first
+     * \return true if the message was pushed to the #CAPLayer, false otherwise
+     */
+    bool sendInCAP(IDSMEMessage* msg, CAPClass::CAP_Class capClass);
+
+    /*! Limits the number of CAP queue entries a class may occupy.
+     *
+     * \param capClass The class to limit
+     * \param limit The maximum number of entries, at most CAP_QUEUE_SIZE
+     */
+    void setCAPClassLimit(CAPClass::CAP_Class capClass, uint16_t limit);
+
 
     inline NeighborQueue<MAX_NEIGHBORS>& getNeighborQueue() {
         return neighborQueue;
@@ -91,6 +113,16 @@ public:
         neighborQueue.addNeighbor(n);
     }
 
+    /*! Returns the delivery estimates of the outgoing links, fed by all acknowledged GTS and CSMA transmissions.
+     */
+    inline LinkQualityTable& getLinkQualityTable() {
+        return linkQualityTable;
+    }
+
+    inline LinkCapacityTable& getLinkCapacityTable() {
+        return linkCapacityTable;
+    }
+
     inline bool neighborExists(const IEEE802154MacAddress& address) {
         return neighborQueue.findByAddress(address) != neighborQueue.end();
     }
@@ -99,6 +131,29 @@ public:
         this->multiplePacketsPerGTS = multiplePacketsPerGTS;
     }
 
+    /*! Lets the receiver of multiple frames during a GTS acknowledge all of them with a single group ACK
+     *  requested after the last frame instead of acknowledging every frame. Only the missing frames are retransmitted.
+     *  Only effective if multiple packets per GTS are sent and has to be set equally on all devices.
+     *
+     * \param groupAck true to enable group acknowledgements
+     */
+    inline void setGroupAck(bool groupAck) {
+        this->groupAck = groupAck;
+    }
+
+    inline bool isGroupAckActive() const {
+        return this->multiplePacketsPerGTS && this->groupAck;
+    }
+
+    /*! Limits the number of GTS queue entries a traffic class may occupy.
+     *
+     * \param trafficClass The traffic class to limit
+     * \param limit The maximum number of entries, at most TOTAL_GTS_QUEUE_SIZE
+     */
+    inline void setTrafficClassLimit(TrafficClass::Traffic_Class trafficClass, queue_size_t limit) {
+        neighborQueue.setTrafficClassLimit(trafficClass, limit);
+    }
+
 
 /* Event handlers (START) ----------------------------------------------------*/
     /*! This shall be called shortly before the start of every slot to allow for setting up the transceiver.
@@ -157,14 +212,35 @@ protected:
 
     AckLayer::done_callback_t doneGTS;
 
+    AckLayer::done_callback_t doneGroupAck;
+
     IDSMEMessage* dsmeAckFrame;
 
     NeighborQueue<MAX_NEIGHBORS> neighborQueue;
 
     NeighborQueue<MAX_NEIGHBORS>::iterator lastSendGTSNeighbor;
 
+    LinkQualityTable linkQualityTable;
+
+    LinkCapacityTable linkCapacityTable;
+
+    /* symbol counter at the start of the current transmission attempt during a GTS */
+    uint32_t gtsAttemptStart{0};
+
     IDSMEMessage *preparedMsg{nullptr};
 
+    /* sender side of the group ACK: frames sent during the current GTS that await the group ACK */
+    IDSMEMessage* groupAckPending[GROUP_ACK_WINDOW];
+    uint8_t numGroupAckPending{0};
+    uint8_t numGroupAckFrames{0};
+    IDSMEMessage* groupAckCandidate{nullptr};
+    bool groupAckLast{false};
+    bool groupAckRequestPending{false};
+    bool waitingForGroupAck{false};
+
+    /* receiver side of the group ACK: sequence numbers recently received per neighbor */
+    GroupAckWindow groupAckWindow;
+
     /*!
      * Called on start of every GTSlot.
      * Switch channel for reception or transmit from queue in allocated slots. TODO: correct?
@@ -183,6 +259,70 @@ protected:
      */
     bool prepareNextMessageIfAny();
 
+    /*! Selects the next message for the current neighbor. The traffic classes are served
+     *  in strict priority, except for messages whose deadline is closer than one
+     *  multi-superframe, which are served earliest deadline first. Messages that can not
+     *  meet their deadline anymore are dropped on the way.
+     *\param exclude If set, the message is skipped and nothing is dropped, i.e., the
+     *        message that will follow the transmission of exclude is returned.
+     *\return the selected message or nullptr if no message is queued
+     */
+    IDSMEMessage* selectNextMessage(IDSMEMessage* exclude = nullptr);
+
+    /*! Lets the ACKLayer serialize the message that is expected to follow currentMsg
+     *  during the ongoing transmission, so only the IFS remains between both frames.
+     */
+    void prepareFollowingMessage(IDSMEMessage* currentMsg);
+
+    /*! Removes an expired message from the front of its queue and confirms it with TRANSACTION_EXPIRED.
+     */
+    void dropExpiredMessage(IDSMEMessage* msg);
+
+    /*! Returns the number of symbols required to transmit a message and to receive its acknowledgement, including the IFS.
+     */
+    uint32_t getGTSTransmissionDuration(IDSMEMessage* msg);
+
+    /*! Returns the remaining time in symbols until a message would have to be started to be delivered before its deadline.
+     */
+    int32_t getSlack(IDSMEMessage* msg);
+
+    bool isBeyondDeadline(IDSMEMessage* msg);
+
+    /*! Returns the number of symbols required to request and receive a group ACK after the last frame of a GTS.
+     */
+    uint32_t getGroupAckWaitDuration();
+
+    /*! Sets up the header of a message that is sent in group ACK mode. Messages that request an acknowledgement
+     *  are sent without immediate ACK if their sequence number fits into the window of the group.
+     *  Also decides if the message is the last one of the group.
+     */
+    void prepareGroupAckTransmission(IDSMEMessage* msg);
+
+    /*! Continues the GTS after a frame was sent, i.e. prepares the next frame, requests the group ACK or finalizes the GTS.
+     */
+    void continueGTSTransmission(bool lastOfGroup);
+
+    /*! Confirms all acknowledged frames of the group and requeues the missing frames for retransmission.
+     */
+    void resolveGroupAck(const GroupAckCmd& ack);
+
+    /*! Called on reception of a group ACK, finalizes the GTS if the group ACK was expected.
+     */
+    void handleGroupAck(IDSMEMessage* msg);
+
+    /*! Sends the group ACK request after the last frame of the group.
+     */
+    void sendGroupAckRequest();
+
+    /*! Called on reception of a group ACK request, answers with the group ACK if a GTS is received from the sender.
+     */
+    void handleGroupAckRequest(IDSMEMessage* msg);
+
+    void sendGroupAck(uint16_t destination, uint8_t baseSequenceNumber);
+    void prepareGroupAckHeader(IDSMEMessage* msg, uint16_t destination);
+
+    void sendDoneGroupAck(enum AckLayerResponse response, IDSMEMessage* msg);
+
     /*! Transmits the prepared GTS message by passing the message to the ACKLayer.
      *  The MessageDispatcher maintains ownership of the packet so it must not be
      *  deleted before the ACKLayer finishes the transmission. The callback-function
@@ -231,6 +371,10 @@ public:
         return this->numUnusedRxGts;
     }
 
+    long getNumDeadlineMisses() const {
+        return this->numDeadlineMisses;
+    }
+
 private:
     long numTxGtsFrames = 0;
     long numRxAckFrames = 0;
@@ -240,6 +384,7 @@ private:
     long numUpperPacketsDroppedFullQueue = 0;
     long numUpperPacketsForCAP = 0;
     long numUpperPacketsForGTS = 0;
+    long numDeadlineMisses = 0;
     bool recordGtsUpdates = false;
 /* Statistics (END) --------------------------------------------------------- */
 };
@@ -0,0 +1,120 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef GTSNOTIFYBUNDLECMD_H_
+#define GTSNOTIFYBUNDLECMD_H_
+
+#include "../../helper/Integers.h"
+#include "../../mac_services/dataStructures/DSMEMessageElement.h"
+#include "./GTSManagement.h"
+#include "./GTSReplyNotifyCmd.h"
+
+#ifndef DSME_GTS_NOTIFY_BUNDLE_MAX_ENTRIES
+#define DSME_GTS_NOTIFY_BUNDLE_MAX_ENTRIES 4
+#endif
+
+namespace dsme {
+
+/* maximum number of notify commands in a single bundle, the frame size is checked separately */
+constexpr uint8_t GTS_NOTIFY_BUNDLE_MAX_ENTRIES = DSME_GTS_NOTIFY_BUNDLE_MAX_ENTRIES;
+
+/*
+ * Several DSME-GTS notify commands of the same device coalesced into one frame.
+ * Every entry consists of the management field and the notify command as in a DSME-GTS notify command frame.
+ */
+class GTSNotifyBundleCmd : public DSMEMessageElement {
+private:
+    uint8_t numEntries;
+    GTSManagement management[GTS_NOTIFY_BUNDLE_MAX_ENTRIES];
+    GTSReplyNotifyCmd notify[GTS_NOTIFY_BUNDLE_MAX_ENTRIES];
+
+public:
+    GTSNotifyBundleCmd() : numEntries(0) {
+    }
+
+    uint8_t getNumEntries() const {
+        return numEntries;
+    }
+
+    GTSManagement& getManagement(uint8_t i) {
+        return management[i];
+    }
+
+    GTSReplyNotifyCmd& getNotify(uint8_t i) {
+        return notify[i];
+    }
+
+    bool addEntry(const GTSManagement& management, const GTSReplyNotifyCmd& notify) {
+        if(numEntries >= GTS_NOTIFY_BUNDLE_MAX_ENTRIES) {
+            return false;
+        }
+        this->management[numEntries] = management;
+        this->notify[numEntries] = notify;
+        numEntries++;
+        return true;
+    }
+
+    virtual uint8_t getSerializationLength() {
+        uint8_t size = 1;
+        for(uint8_t i = 0; i < numEntries; i++) {
+            size += management[i].getSerializationLength();
+            size += notify[i].getSerializationLength();
+        }
+        return size;
+    }
+
+    virtual void serialize(Serializer& serializer) {
+        serializer << numEntries;
+        if(numEntries > GTS_NOTIFY_BUNDLE_MAX_ENTRIES) {
+            /* '-> malformed */
+            numEntries = 0;
+        }
+        for(uint8_t i = 0; i < numEntries; i++) {
+            management[i].serialize(serializer);
+            notify[i].serialize(serializer);
+        }
+    }
+};
+
+} /* namespace dsme */
+
+#endif /* GTSNOTIFYBUNDLECMD_H_ */
@@ -0,0 +1,122 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef GROUPACKCMD_H_
+#define GROUPACKCMD_H_
+
+#include "../../helper/Integers.h"
+#include "../../mac_services/dataStructures/DSMEMessageElement.h"
+
+namespace dsme {
+
+/* maximum number of frames that can be acknowledged by a single group ACK */
+constexpr uint8_t GROUP_ACK_WINDOW = 16;
+
+/*
+ * Acknowledges all frames received from a device during one GTS.
+ * Bit i of the bitmap is set if the frame with the sequence number baseSequenceNumber + i was received.
+ */
+class GroupAckCmd : public DSMEMessageElement {
+private:
+    uint8_t baseSequenceNumber;
+    uint16_t bitmap;
+
+public:
+    GroupAckCmd() : baseSequenceNumber(0), bitmap(0) {
+    }
+
+    GroupAckCmd(uint8_t baseSequenceNumber, uint16_t bitmap) : baseSequenceNumber(baseSequenceNumber), bitmap(bitmap) {
+    }
+
+    uint8_t getBaseSequenceNumber() const {
+        return baseSequenceNumber;
+    }
+
+    uint16_t getBitmap() const {
+        return bitmap;
+    }
+
+    bool isAcknowledged(uint8_t sequenceNumber) const {
+        uint8_t offset = sequenceNumber - baseSequenceNumber;
+        return offset < GROUP_ACK_WINDOW && (bitmap & (1 << offset));
+    }
+
+    virtual uint8_t getSerializationLength() {
+        return 3;
+    }
+
+    virtual void serialize(Serializer& serializer) {
+        serializer << baseSequenceNumber;
+        serializer << bitmap;
+    }
+};
+
+/*
+ * Sent after the last frame of a GTS, the receiver answers with the group ACK for the given base sequence number.
+ */
+class GroupAckRequestCmd : public DSMEMessageElement {
+private:
+    uint8_t baseSequenceNumber;
+
+public:
+    GroupAckRequestCmd() : baseSequenceNumber(0) {
+    }
+
+    explicit GroupAckRequestCmd(uint8_t baseSequenceNumber) : baseSequenceNumber(baseSequenceNumber) {
+    }
+
+    uint8_t getBaseSequenceNumber() const {
+        return baseSequenceNumber;
+    }
+
+    virtual uint8_t getSerializationLength() {
+        return 1;
+    }
+
+    virtual void serialize(Serializer& serializer) {
+        serializer << baseSequenceNumber;
+    }
+};
+
+} /* namespace dsme */
+
+#endif /* GROUPACKCMD_H_ */
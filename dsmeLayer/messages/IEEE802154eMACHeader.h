@@ -239,6 +239,10 @@ public:
         this->frameControl.ieListPresent = present;
     }
 
+    bool isIEListPresent() const {
+        return this->frameControl.ieListPresent;
+    }
+
     void setSeqNumSuppression(bool suppression) {
         finalized = false;
         this->frameControl.seqNumSuppression = suppression;
@@ -0,0 +1,137 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef SCHEDULEPUSHCMD_H_
+#define SCHEDULEPUSHCMD_H_
+
+#include "../../helper/Integers.h"
+#include "../../mac_services/dataStructures/DSMEMessageElement.h"
+
+namespace dsme {
+
+/* maximum number of allocations in a single push command, limited by the frame size */
+constexpr uint8_t SCHEDULE_PUSH_MAX_ALLOCATIONS = 14;
+
+/* a schedule is split into at most this number of push commands */
+constexpr uint8_t SCHEDULE_PUSH_MAX_FRAGMENTS = 16;
+
+struct ScheduleAllocation {
+    uint16_t transmitter;
+    uint16_t receiver;
+    uint8_t superframeID;
+    uint8_t slotID;
+    uint8_t channel;
+};
+
+/*
+ * One fragment of the schedule computed by the PAN coordinator.
+ * A device replaces its allocations once all fragments of a new schedule version were received.
+ */
+class SchedulePushCmd : public DSMEMessageElement {
+private:
+    uint8_t version;
+    uint8_t fragment;
+    uint8_t numFragments;
+    uint8_t numAllocations;
+    ScheduleAllocation allocations[SCHEDULE_PUSH_MAX_ALLOCATIONS];
+
+public:
+    SchedulePushCmd() : version(0), fragment(0), numFragments(0), numAllocations(0) {
+    }
+
+    SchedulePushCmd(uint8_t version, uint8_t fragment, uint8_t numFragments) : version(version), fragment(fragment), numFragments(numFragments), numAllocations(0) {
+    }
+
+    uint8_t getVersion() const {
+        return version;
+    }
+
+    uint8_t getFragment() const {
+        return fragment;
+    }
+
+    uint8_t getNumFragments() const {
+        return numFragments;
+    }
+
+    uint8_t getNumAllocations() const {
+        return numAllocations;
+    }
+
+    const ScheduleAllocation& getAllocation(uint8_t i) const {
+        return allocations[i];
+    }
+
+    bool addAllocation(const ScheduleAllocation& allocation) {
+        if(numAllocations >= SCHEDULE_PUSH_MAX_ALLOCATIONS) {
+            return false;
+        }
+        allocations[numAllocations++] = allocation;
+        return true;
+    }
+
+    virtual uint8_t getSerializationLength() {
+        return 4 + numAllocations * 7;
+    }
+
+    virtual void serialize(Serializer& serializer) {
+        serializer << version;
+        serializer << fragment;
+        serializer << numFragments;
+        serializer << numAllocations;
+        if(numAllocations > SCHEDULE_PUSH_MAX_ALLOCATIONS) {
+            /* '-> malformed */
+            numAllocations = 0;
+        }
+        for(uint8_t i = 0; i < numAllocations; i++) {
+            serializer << allocations[i].transmitter;
+            serializer << allocations[i].receiver;
+            serializer << allocations[i].superframeID;
+            serializer << allocations[i].slotID;
+            serializer << allocations[i].channel;
+        }
+    }
+};
+
+} /* namespace dsme */
+
+#endif /* SCHEDULEPUSHCMD_H_ */
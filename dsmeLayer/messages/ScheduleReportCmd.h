@@ -0,0 +1,120 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef SCHEDULEREPORTCMD_H_
+#define SCHEDULEREPORTCMD_H_
+
+#include "../../helper/Integers.h"
+#include "../../mac_services/dataStructures/DSMEMessageElement.h"
+
+namespace dsme {
+
+/* maximum number of links in a single report, limited by the frame size */
+constexpr uint8_t SCHEDULE_REPORT_MAX_LINKS = 16;
+
+struct ScheduleReportLink {
+    uint16_t destination;
+    uint8_t slotDemand; // number of TX slots required
+    uint8_t backlog;    // frames queued for the destination
+    uint16_t etx;       // in units of 1/LinkQualityTable::ETX_ONE
+};
+
+/*
+ * Reports the TX links of a device to the PAN coordinator for the central scheduling.
+ * The reporter is part of the payload, since the report is forwarded hop by hop.
+ */
+class ScheduleReportCmd : public DSMEMessageElement {
+private:
+    uint16_t reporter;
+    uint8_t numLinks;
+    ScheduleReportLink links[SCHEDULE_REPORT_MAX_LINKS];
+
+public:
+    ScheduleReportCmd() : reporter(0xffff), numLinks(0) {
+    }
+
+    explicit ScheduleReportCmd(uint16_t reporter) : reporter(reporter), numLinks(0) {
+    }
+
+    uint16_t getReporter() const {
+        return reporter;
+    }
+
+    uint8_t getNumLinks() const {
+        return numLinks;
+    }
+
+    const ScheduleReportLink& getLink(uint8_t i) const {
+        return links[i];
+    }
+
+    bool addLink(const ScheduleReportLink& link) {
+        if(numLinks >= SCHEDULE_REPORT_MAX_LINKS) {
+            return false;
+        }
+        links[numLinks++] = link;
+        return true;
+    }
+
+    virtual uint8_t getSerializationLength() {
+        return 2 + 1 + numLinks * 6;
+    }
+
+    virtual void serialize(Serializer& serializer) {
+        serializer << reporter;
+        serializer << numLinks;
+        if(numLinks > SCHEDULE_REPORT_MAX_LINKS) {
+            /* '-> malformed */
+            numLinks = 0;
+        }
+        for(uint8_t i = 0; i < numLinks; i++) {
+            serializer << links[i].destination;
+            serializer << links[i].slotDemand;
+            serializer << links[i].backlog;
+            serializer << links[i].etx;
+        }
+    }
+};
+
+} /* namespace dsme */
+
+#endif /* SCHEDULEREPORTCMD_H_ */
@@ -0,0 +1,115 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef TIMECORRECTIONIE_H_
+#define TIMECORRECTIONIE_H_
+
+#include "../../helper/Integers.h"
+#include "../../mac_services/dataStructures/DSMEMessageElement.h"
+
+namespace dsme {
+
+/*
+ * Time Correction IE as carried in Enhanced-ACKs (See IEEE 802.15.4-2015 7.4.2.7).
+ * Within openDSME the time correction is given in symbols instead of microseconds.
+ */
+class TimeCorrectionIE : public DSMEMessageElement {
+public:
+    static constexpr uint8_t ELEMENT_ID = 0x1e;
+    static constexpr uint8_t CONTENT_LENGTH = 2;
+
+    /* header IE descriptor: length (bits 0-6), element ID (bits 7-14), type 0 (bit 15) */
+    static constexpr uint16_t DESCRIPTOR = CONTENT_LENGTH | (ELEMENT_ID << 7);
+
+    TimeCorrectionIE() : descriptor(DESCRIPTOR), content(0) {
+    }
+
+    TimeCorrectionIE(int16_t timeCorrection, bool nack) : descriptor(DESCRIPTOR), content(encode(timeCorrection, nack)) {
+    }
+
+    /**
+     * Time synchronization information (bits 0-11, two's complement, saturated) and ACK/NACK (bit 15)
+     */
+    static uint16_t encode(int16_t timeCorrection, bool nack) {
+        if(timeCorrection > 2047) {
+            timeCorrection = 2047;
+        } else if(timeCorrection < -2048) {
+            timeCorrection = -2048;
+        }
+
+        uint16_t encoded = static_cast<uint16_t>(timeCorrection) & 0x0FFF;
+        if(nack) {
+            encoded |= 0x8000;
+        }
+        return encoded;
+    }
+
+    bool isValid() const {
+        return descriptor == DESCRIPTOR;
+    }
+
+    int16_t getTimeCorrection() const {
+        /* sign extension of the 12 bit value */
+        return static_cast<int16_t>(static_cast<uint16_t>(content << 4)) >> 4;
+    }
+
+    bool isNack() const {
+        return content & 0x8000;
+    }
+
+    virtual uint8_t getSerializationLength() {
+        return 2 + CONTENT_LENGTH;
+    }
+
+    virtual void serialize(Serializer& serializer) {
+        serializer << descriptor;
+        serializer << content;
+    }
+
+private:
+    uint16_t descriptor;
+    uint16_t content;
+};
+
+} /* namespace dsme */
+
+#endif /* TIMECORRECTIONIE_H_ */
@@ -46,6 +46,7 @@
 /* INCLUDES ******************************************************************/
 
 #include "../../helper/Integers.h"
+#include "../../mac_services/DSME_Common.h"
 #include "./MessageQueueEntry.h"
 #include "./NeighborListEntry.h"
 
@@ -58,7 +59,9 @@ typedef uint8_t queue_size_t;
 /* CLASSES *******************************************************************/
 
 /**
- * A queue for a fixed maximum number of messages for different neighbors
+ * A queue for a fixed maximum number of messages for different neighbors.
+ * Every neighbor holds one FIFO per traffic class, all of them share the same pool of entries.
+ * The number of entries a single traffic class may occupy in the pool can be limited.
  * @template-param T type of nodes to store
  * @template-param S size of allocated chunk
  */
@@ -93,28 +96,63 @@ public:
      * -> time: O(1)
      * @param neighbor the neighbor the message belongs to
      * @param msg pointer to the message, ownership STAYS with caller
+     * @param trafficClass the traffic class the message is queued in
      */
-    void push_back(NeighborListEntry<T>& neighbor, T* msg);
+    void push_back(NeighborListEntry<T>& neighbor, T* msg, uint8_t trafficClass);
 
     /**
-     * Gets and removes the first (oldest) element of the queue of a neighbor, nullptr if not existent
+     * Re-inserts a message at the front of the queue of a neighbor, e.g. after it was taken out for a transmission
+     * that has to be repeated. The limit of the traffic class is not checked, only the pool must not be full.
      * -> time: O(1)
      * @param neighbor the neighbor the message belongs to
+     * @param msg pointer to the message, ownership STAYS with caller
+     * @param trafficClass the traffic class the message is queued in
+     */
+    void push_front(NeighborListEntry<T>& neighbor, T* msg, uint8_t trafficClass);
+
+    /**
+     * Gets and removes the first (oldest) element of the highest priority non-empty traffic class of a neighbor, nullptr if not existent
+     * -> time: O(NUM_TRAFFIC_CLASSES)
+     * @param neighbor the neighbor the message belongs to
      */
     T* pop_front(NeighborListEntry<T>& neighbor);
 
     /**
-     * Gets the first (oldest) element of the queue of a neighbor, nullptr if not existent
+     * Gets and removes the first (oldest) element of a traffic class of a neighbor, nullptr if not existent
      * -> time: O(1)
      * @param neighbor the neighbor the message belongs to
+     * @param trafficClass the traffic class to take the message from
+     */
+    T* pop_front(NeighborListEntry<T>& neighbor, uint8_t trafficClass);
+
+    /**
+     * Gets the first (oldest) element of the highest priority non-empty traffic class of a neighbor, nullptr if not existent
+     * -> time: O(NUM_TRAFFIC_CLASSES)
+     * @param neighbor the neighbor the message belongs to
      */
     T* front(const NeighborListEntry<T>& neighbor);
 
+    /**
+     * Gets the first (oldest) element of a traffic class of a neighbor, nullptr if not existent
+     * -> time: O(1)
+     * @param neighbor the neighbor the message belongs to
+     * @param trafficClass the traffic class to look at
+     */
+    T* front(const NeighborListEntry<T>& neighbor, uint8_t trafficClass);
+
+    /**
+     * Gets the element following the first element of a traffic class of a neighbor, nullptr if not existent
+     * -> time: O(1)
+     * @param neighbor the neighbor the message belongs to
+     * @param trafficClass the traffic class to look at
+     */
+    T* second(const NeighborListEntry<T>& neighbor, uint8_t trafficClass);
+
     /**
      * Deletes all [but first] messages from the queue of a neighbor
      * -> time: O(neighbor->queueSize)
      * @param neighbor the neighbor the messages belong to
-     * @param if true, first message is preserved
+     * @param if true, first message of the highest priority non-empty traffic class is preserved
      */
     void flush(NeighborListEntry<T>& neighbor, bool keepFront);
 
@@ -122,6 +160,27 @@ public:
         return full;
     }
 
+    /**
+     * Checks if another message of the given traffic class can be queued
+     * @param trafficClass the traffic class to check
+     */
+    bool isFull(uint8_t trafficClass) const {
+        return full || classOccupancy[trafficClass] >= classLimit[trafficClass];
+    }
+
+    /**
+     * Limits the number of entries a traffic class may occupy in the shared pool
+     * @param trafficClass the traffic class to limit
+     * @param limit maximum number of entries, at most S
+     */
+    void setClassLimit(uint8_t trafficClass, queue_size_t limit) {
+        classLimit[trafficClass] = (limit < S) ? limit : S;
+    }
+
+    queue_size_t getClassOccupancy(uint8_t trafficClass) const {
+        return classOccupancy[trafficClass];
+    }
+
 private:
     Chunk chunk;
 
@@ -131,7 +190,17 @@ private:
     MessageQueueEntry<T>* freeFront;
     MessageQueueEntry<T>* freeBack;
 
+    /* number of entries currently occupied by each traffic class */
+    queue_size_t classOccupancy[NUM_TRAFFIC_CLASSES];
+
+    /* maximum number of entries each traffic class may occupy */
+    queue_size_t classLimit[NUM_TRAFFIC_CLASSES];
+
     inline void addToFree(MessageQueueEntry<T>* entry);
+
+    inline MessageQueueEntry<T>* takeFromFree();
+
+    void flushClass(NeighborListEntry<T>& neighbor, uint8_t trafficClass, bool keepFront);
 };
 
 /* FUNCTION DEFINITIONS ******************************************************/
@@ -140,6 +209,11 @@ template <typename T, uint8_t S>
 MultiMessageQueue<T, S>::MultiMessageQueue() : full(false) {
     this->freeFront = &(this->chunk.data[0]);
     this->freeBack = &(this->chunk.data[S - 1]);
+
+    for(uint8_t i = 0; i < NUM_TRAFFIC_CLASSES; i++) {
+        this->classOccupancy[i] = 0;
+        this->classLimit[i] = S;
+    }
 }
 
 template <typename T, uint8_t S>
@@ -147,57 +221,88 @@ MultiMessageQueue<T, S>::~MultiMessageQueue() {
 }
 
 template <typename T, uint8_t S>
-void MultiMessageQueue<T, S>::push_back(NeighborListEntry<T>& neighbor, T* msg) {
-    if(this->full) {
+void MultiMessageQueue<T, S>::push_back(NeighborListEntry<T>& neighbor, T* msg, uint8_t trafficClass) {
+    DSME_ASSERT(trafficClass < NUM_TRAFFIC_CLASSES);
+
+    if(this->isFull(trafficClass)) {
         /* '-> all slots are used */
         DSME_ASSERT(false);
         return;
     }
 
-    MessageQueueEntry<T>* entry = this->freeFront;
+    MessageQueueEntry<T>* entry = takeFromFree();
+    entry->value = msg;
+    entry->next = nullptr;
 
-    if(this->freeFront == this->freeBack) {
-        /* '-> this was the last free spot */
-        this->freeFront = nullptr;
-        this->freeBack = nullptr;
-        this->full = true;
-    } else {
-        /* '-> still multiple empty spots left */
-        this->freeFront = this->freeFront->next;
+    if(neighbor.messageBack[trafficClass] != nullptr) {
+        neighbor.messageBack[trafficClass]->next = entry;
     }
+    neighbor.messageBack[trafficClass] = entry;
 
-    entry->value = msg;
-    entry->next = nullptr;
+    if(neighbor.messageFront[trafficClass] == nullptr) {
+        neighbor.messageFront[trafficClass] = neighbor.messageBack[trafficClass];
+    }
 
-    if(neighbor.messageBack != nullptr) {
-        neighbor.messageBack->next = entry;
+    neighbor.queueSize++;
+    this->classOccupancy[trafficClass]++;
+}
+
+template <typename T, uint8_t S>
+void MultiMessageQueue<T, S>::push_front(NeighborListEntry<T>& neighbor, T* msg, uint8_t trafficClass) {
+    DSME_ASSERT(trafficClass < NUM_TRAFFIC_CLASSES);
+
+    if(this->full) {
+        /* '-> all slots are used */
+        DSME_ASSERT(false);
+        return;
     }
-    neighbor.messageBack = entry;
 
-    if(neighbor.messageFront == nullptr) {
-        neighbor.messageFront = neighbor.messageBack;
+    MessageQueueEntry<T>* entry = takeFromFree();
+    entry->value = msg;
+    entry->next = neighbor.messageFront[trafficClass];
+
+    neighbor.messageFront[trafficClass] = entry;
+
+    if(neighbor.messageBack[trafficClass] == nullptr) {
+        neighbor.messageBack[trafficClass] = entry;
     }
 
     neighbor.queueSize++;
+    this->classOccupancy[trafficClass]++;
 }
 
 template <typename T, uint8_t S>
 T* MultiMessageQueue<T, S>::pop_front(NeighborListEntry<T>& neighbor) {
-    if(neighbor.queueSize > 0) {
-        /* '-> queue contains messages for this neighbor */
+    for(uint8_t i = 0; i < NUM_TRAFFIC_CLASSES; i++) {
+        if(neighbor.messageFront[i] != nullptr) {
+            return pop_front(neighbor, i);
+        }
+    }
+
+    /* '-> no messages pending for this neighbor */
+    return nullptr;
+}
 
-        MessageQueueEntry<T>* entry = neighbor.messageFront;
+template <typename T, uint8_t S>
+T* MultiMessageQueue<T, S>::pop_front(NeighborListEntry<T>& neighbor, uint8_t trafficClass) {
+    DSME_ASSERT(trafficClass < NUM_TRAFFIC_CLASSES);
+
+    if(neighbor.messageFront[trafficClass] != nullptr) {
+        /* '-> queue contains messages of this class for this neighbor */
+
+        MessageQueueEntry<T>* entry = neighbor.messageFront[trafficClass];
         T* msg = entry->value;
 
-        neighbor.messageFront = entry->next;
+        neighbor.messageFront[trafficClass] = entry->next;
 
-        if(neighbor.messageFront == nullptr) {
-            neighbor.messageBack = nullptr;
+        if(neighbor.messageFront[trafficClass] == nullptr) {
+            neighbor.messageBack[trafficClass] = nullptr;
         }
 
         this->addToFree(entry);
 
         neighbor.queueSize--;
+        this->classOccupancy[trafficClass]--;
         this->full = false;
         return msg;
     } else {
@@ -208,24 +313,53 @@ T* MultiMessageQueue<T, S>::pop_front(NeighborListEntry<T>& neighbor) {
 
 template <typename T, uint8_t S>
 T* MultiMessageQueue<T, S>::front(const NeighborListEntry<T>& neighbor) {
-    return (neighbor.messageFront != nullptr) ? neighbor.messageFront->value : nullptr;
+    for(uint8_t i = 0; i < NUM_TRAFFIC_CLASSES; i++) {
+        if(neighbor.messageFront[i] != nullptr) {
+            return neighbor.messageFront[i]->value;
+        }
+    }
+    return nullptr;
+}
+
+template <typename T, uint8_t S>
+T* MultiMessageQueue<T, S>::front(const NeighborListEntry<T>& neighbor, uint8_t trafficClass) {
+    DSME_ASSERT(trafficClass < NUM_TRAFFIC_CLASSES);
+    return (neighbor.messageFront[trafficClass] != nullptr) ? neighbor.messageFront[trafficClass]->value : nullptr;
+}
+
+template <typename T, uint8_t S>
+T* MultiMessageQueue<T, S>::second(const NeighborListEntry<T>& neighbor, uint8_t trafficClass) {
+    DSME_ASSERT(trafficClass < NUM_TRAFFIC_CLASSES);
+    MessageQueueEntry<T>* entry = neighbor.messageFront[trafficClass];
+    return (entry != nullptr && entry->next != nullptr) ? entry->next->value : nullptr;
 }
 
 template <typename T, uint8_t S>
 void MultiMessageQueue<T, S>::flush(NeighborListEntry<T>& neighbor, bool keepFront) {
-    MessageQueueEntry<T>* entry = neighbor.messageFront;
+    for(uint8_t i = 0; i < NUM_TRAFFIC_CLASSES; i++) {
+        if(keepFront && neighbor.messageFront[i] != nullptr) {
+            /* only the overall first entry is kept */
+            flushClass(neighbor, i, true);
+            keepFront = false;
+        } else {
+            flushClass(neighbor, i, false);
+        }
+    }
+    return;
+}
+
+template <typename T, uint8_t S>
+void MultiMessageQueue<T, S>::flushClass(NeighborListEntry<T>& neighbor, uint8_t trafficClass, bool keepFront) {
+    MessageQueueEntry<T>* entry = neighbor.messageFront[trafficClass];
 
     if(keepFront && entry != nullptr) {
         /* keep existing first entry */
         MessageQueueEntry<T>* temp = entry;
         entry = entry->next;
         temp->next = nullptr;
-
-        neighbor.queueSize = 1;
     } else {
         /* discard first entry or list already empty */
-        neighbor.messageFront = nullptr;
-        neighbor.queueSize = 0;
+        neighbor.messageFront[trafficClass] = nullptr;
     }
 
     if(entry != nullptr) {
@@ -233,6 +367,9 @@ void MultiMessageQueue<T, S>::flush(NeighborListEntry<T>& neighbor, bool keepFro
         this->full = false;
     } else {
         /* '-> nothing to do */
+        if(neighbor.messageFront[trafficClass] == nullptr) {
+            neighbor.messageBack[trafficClass] = nullptr;
+        }
         return;
     }
 
@@ -240,16 +377,20 @@ void MultiMessageQueue<T, S>::flush(NeighborListEntry<T>& neighbor, bool keepFro
      * taken out of the loop for efficiency
      */
     this->addToFree(entry);
+    neighbor.queueSize--;
+    this->classOccupancy[trafficClass]--;
     entry = entry->next;
 
     while(entry != nullptr) {
         entry->value = nullptr;
         this->freeBack->next = entry;
         this->freeBack = entry;
+        neighbor.queueSize--;
+        this->classOccupancy[trafficClass]--;
         entry = entry->next;
     }
 
-    neighbor.messageBack = neighbor.messageFront;
+    neighbor.messageBack[trafficClass] = neighbor.messageFront[trafficClass];
     return;
 }
 
@@ -269,6 +410,23 @@ inline void MultiMessageQueue<T, S>::addToFree(MessageQueueEntry<T>* entry) {
     return;
 }
 
+template <typename T, uint8_t S>
+inline MessageQueueEntry<T>* MultiMessageQueue<T, S>::takeFromFree() {
+    MessageQueueEntry<T>* entry = this->freeFront;
+    DSME_ASSERT(entry != nullptr);
+
+    if(this->freeFront == this->freeBack) {
+        /* '-> this was the last free spot */
+        this->freeFront = nullptr;
+        this->freeBack = nullptr;
+        this->full = true;
+    } else {
+        /* '-> still multiple empty spots left */
+        this->freeFront = this->freeFront->next;
+    }
+    return entry;
+}
+
 } /* namespace dsme */
 
 #endif /* MULTIMESSAGEQUEUE_H_ */
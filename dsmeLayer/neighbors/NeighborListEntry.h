@@ -45,6 +45,7 @@
 
 /* INCLUDES ******************************************************************/
 
+#include "../../mac_services/DSME_Common.h"
 #include "./MultiMessageQueue.h"
 #include "./Neighbor.h"
 
@@ -62,8 +63,9 @@ public:
     explicit NeighborListEntry(Neighbor& neighbor);
     virtual ~NeighborListEntry() = default;
 
-    MessageQueueEntry<T>* messageFront;
-    MessageQueueEntry<T>* messageBack;
+    /* one FIFO per traffic class, index 0 has the highest priority */
+    MessageQueueEntry<T>* messageFront[NUM_TRAFFIC_CLASSES];
+    MessageQueueEntry<T>* messageBack[NUM_TRAFFIC_CLASSES];
 
     queue_size_t queueSize;
 };
@@ -71,7 +73,11 @@ public:
 /* FUNCTION DEFINITIONS ******************************************************/
 
 template <typename T>
-NeighborListEntry<T>::NeighborListEntry(Neighbor& neighbor) : Neighbor(neighbor), messageFront(nullptr), messageBack(nullptr), queueSize(0) {
+NeighborListEntry<T>::NeighborListEntry(Neighbor& neighbor) : Neighbor(neighbor), queueSize(0) {
+    for(uint8_t i = 0; i < NUM_TRAFFIC_CLASSES; i++) {
+        messageFront[i] = nullptr;
+        messageBack[i] = nullptr;
+    }
 }
 
 } /* namespace dsme */
@@ -97,11 +97,18 @@ public:
     queue_size_t getPacketsInQueue(const iterator& neighbor) const;
     bool isQueueEmpty(iterator& neighbor);
 
+    /*
+     * gives the first message of the highest priority non-empty traffic class
+     */
     IDSMEMessage* front(iterator& neighbor);
+    IDSMEMessage* front(iterator& neighbor, uint8_t trafficClass);
+    IDSMEMessage* second(iterator& neighbor, uint8_t trafficClass);
 
     IDSMEMessage* popFront(iterator& neighbor);
+    IDSMEMessage* popFront(iterator& neighbor, uint8_t trafficClass);
 
-    void pushBack(iterator& neighbor, IDSMEMessage* msg);
+    void pushBack(iterator& neighbor, IDSMEMessage* msg, uint8_t trafficClass);
+    void pushFront(iterator& neighbor, IDSMEMessage* msg, uint8_t trafficClass);
 
     void flushQueues(bool keepFront);
 
@@ -109,6 +116,14 @@ public:
         return queue.isFull();
     }
 
+    bool isQueueFull(uint8_t trafficClass) const {
+        return queue.isFull(trafficClass);
+    }
+
+    void setTrafficClassLimit(uint8_t trafficClass, queue_size_t limit) {
+        queue.setClassLimit(trafficClass, limit);
+    }
+
 private:
     MultiMessageQueue<IDSMEMessage, TOTAL_GTS_QUEUE_SIZE> queue;
     RBTree<NeighborListEntry<IDSMEMessage>, IEEE802154MacAddress> neighbors;
@@ -174,14 +189,35 @@ IDSMEMessage* NeighborQueue<N>::front(iterator& neighbor) {
     return queue.front(*neighbor);
 }
 
+template <uint8_t N>
+IDSMEMessage* NeighborQueue<N>::front(iterator& neighbor, uint8_t trafficClass) {
+    return queue.front(*neighbor, trafficClass);
+}
+
+template <uint8_t N>
+IDSMEMessage* NeighborQueue<N>::second(iterator& neighbor, uint8_t trafficClass) {
+    return queue.second(*neighbor, trafficClass);
+}
+
 template <uint8_t N>
 IDSMEMessage* NeighborQueue<N>::popFront(iterator& neighbor) {
     return queue.pop_front(*neighbor);
 }
 
 template <uint8_t N>
-void NeighborQueue<N>::pushBack(iterator& neighbor, IDSMEMessage* msg) {
-    queue.push_back(*neighbor, msg);
+IDSMEMessage* NeighborQueue<N>::popFront(iterator& neighbor, uint8_t trafficClass) {
+    return queue.pop_front(*neighbor, trafficClass);
+}
+
+template <uint8_t N>
+void NeighborQueue<N>::pushBack(iterator& neighbor, IDSMEMessage* msg, uint8_t trafficClass) {
+    queue.push_back(*neighbor, msg, trafficClass);
+    return;
+}
+
+template <uint8_t N>
+void NeighborQueue<N>::pushFront(iterator& neighbor, IDSMEMessage* msg, uint8_t trafficClass) {
+    queue.push_front(*neighbor, msg, trafficClass);
     return;
 }
 
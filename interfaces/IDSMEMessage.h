@@ -90,6 +90,12 @@ public:
     virtual uint8_t getRetryCounter() = 0;
 
     uint8_t queueAtCreation = -1;
+
+    uint8_t trafficClass = TrafficClass::BEST_EFFORT;
+
+    /* absolute deadline in symbols, only valid if hasDeadline is set */
+    uint32_t deadline = 0;
+    bool hasDeadline = false;
 };
 
 } /* namespace dsme */
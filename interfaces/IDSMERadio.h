@@ -80,11 +80,37 @@ public:
      */
     virtual void abortPreparedTransmission() = 0;
 
+    /**
+     * Prepare a packet in a second transmit buffer while a previously prepared packet is still
+     * being transmitted or acknowledged. A subsequent prepareSendingCopy() for the same message
+     * only has to activate this buffer, preparing any other message discards it.
+     * Returns false if the radio does not provide a second transmit buffer.
+     */
+    virtual bool prepareNextSendingCopy(IDSMEMessage* /* msg */) {
+        return false;
+    }
+
+    /**
+     * Discard a packet prepared via prepareNextSendingCopy()
+     */
+    virtual void discardNextSendingCopy() {
+    }
+
     /**
      * Send an ACK message, delay until aTurnaRoundTime after reception_time has expired
      */
     virtual bool sendDelayedAck(IDSMEMessage* ackMsg, IDSMEMessage* receivedMsg, Delegate<void(bool)> txEndCallback) = 0;
 
+    /**
+     * Send a pre-serialized ACK frame (without FCS) from a static buffer, delay until aTurnaRoundTime after reception_time has expired.
+     * The buffer stays valid until txEndCallback is called.
+     * Returns false if not supported, sendDelayedAck() is used instead.
+     */
+    virtual bool sendDelayedAckFromBuffer(const uint8_t* /* frame */, uint8_t /* length */, IDSMEMessage* /* receivedMsg */,
+                                          Delegate<void(bool)> /* txEndCallback */) {
+        return false;
+    }
+
     /**
      * Specify a delegate that handles incoming messages
      */
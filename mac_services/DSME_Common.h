@@ -71,7 +71,12 @@ enum CommandFrameIdentifier {
     DSME_GTS_REPLY = 0x16,
     DSME_GTS_NOTIFY = 0x17,
     DSME_BEACON_ALLOCATION_NOTIFICATION = 0x1a,
-    DSME_BEACON_COLLISION_NOTIFICATION = 0x1b
+    DSME_BEACON_COLLISION_NOTIFICATION = 0x1b,
+    DSME_GROUP_ACK = 0x30, // not covered by the standard, acknowledges all frames of a GTS at once
+    DSME_SCHEDULE_REPORT = 0x31, // not covered by the standard, demands of a device for the central scheduling
+    DSME_SCHEDULE_PUSH = 0x32, // not covered by the standard, allocations computed by the central scheduling
+    DSME_GTS_NOTIFY_BUNDLE = 0x33, // not covered by the standard, several DSME-GTS notify commands in a single frame
+    DSME_GROUP_ACK_REQUEST = 0x34 // not covered by the standard, requests the group ACK after the last frame of a GTS
 };
 
 struct CapabilityInformation {
@@ -100,6 +105,25 @@ enum Direction { TX = 0x00, RX = 0x01 };
 
 enum Priority { LOW = 0x00, HIGH = 0x01 };
 
+/* Traffic classes for GTS transmissions, lower values are served first (not covered by the standard) */
+struct TrafficClass {
+    enum Traffic_Class { CRITICAL = 0x00, PRIORITY = 0x01, BEST_EFFORT = 0x02 };
+};
+
+constexpr uint8_t NUM_TRAFFIC_CLASSES = 3;
+
+/* Classes for CAP transmissions, lower values are served first (not covered by the standard) */
+struct CAPClass {
+    enum CAP_Class { REPLY = 0x00, COMMAND = 0x01, CRITICAL_DATA = 0x02, DATA = 0x03 };
+
+    /* critical data and data with a deadline overtake the bulk data */
+    static CAP_Class forData(uint8_t trafficClass, bool hasDeadline) {
+        return (trafficClass == TrafficClass::CRITICAL || hasDeadline) ? CRITICAL_DATA : DATA;
+    }
+};
+
+constexpr uint8_t NUM_CAP_CLASSES = 4;
+
 struct GTSStatus {
     enum GTS_Status {
         SUCCESS,
@@ -53,7 +53,15 @@ class ACTElement {
     friend class DSMEAllocationCounterTable;
 
 public:
+    /**
+     * For TX slots the number of failed transmissions since the last reset,
+     * for RX slots the number of multi-superframes since the last reception (5.1.10.5.3).
+     */
     uint16_t getIdleCounter() const {
+        if(direction == Direction::RX) {
+            uint32_t idleMultiSuperframes = *multiSuperframeCounter - lastActivity;
+            return (idleMultiSuperframes > UINT16_MAX) ? UINT16_MAX : idleMultiSuperframes;
+        }
         return idleCounter;
     }
 
@@ -77,12 +85,21 @@ public:
         return direction;
     }
 
+    /**
+     * Only relevant for TX slots, RX slots count the idle multi-superframes on their own.
+     * Use DSMEAllocationCounterTable::incrementIdleCounter to get expired TX slots registered for deallocation.
+     */
     void incrementIdleCounter() {
         idleCounter++;
     }
 
     void resetIdleCounter() {
         idleCounter = 0;
+        lastActivity = *multiSuperframeCounter;
+    }
+
+    uint32_t getLastActivity() const {
+        return lastActivity;
     }
 
     bool operator>(const ACTElement& other) const {
@@ -126,8 +143,17 @@ public:
     }
 
 private:
-    ACTElement(uint16_t superframeID, uint8_t slotID, uint8_t channel, Direction direction, uint16_t address, ACTState state)
-        : superframeID(superframeID), slotID(slotID), channel(channel), direction(direction), address(address), idleCounter(0), state(state) {
+    ACTElement(uint16_t superframeID, uint8_t slotID, uint8_t channel, Direction direction, uint16_t address, ACTState state,
+               const uint32_t* multiSuperframeCounter)
+        : superframeID(superframeID),
+          slotID(slotID),
+          channel(channel),
+          direction(direction),
+          address(address),
+          idleCounter(0),
+          lastActivity(*multiSuperframeCounter),
+          multiSuperframeCounter(multiSuperframeCounter),
+          state(state) {
     }
 
     uint16_t superframeID;
@@ -136,6 +162,8 @@ private:
     Direction direction;
     uint16_t address;
     uint16_t idleCounter;
+    uint32_t lastActivity;                  // multi-superframe of the last reception (RX only)
+    const uint32_t* multiSuperframeCounter; // owned by the DSMEAllocationCounterTable
 
     // Slot state
     // TODO implementation specific, not handled by the standard
@@ -49,6 +49,7 @@
 #include "../../helper/Integers.h"
 #include "../DSME_Common.h"
 #include "../pib/MAC_PIB.h"
+#include "../pib/dsme_mac_constants.h"
 #include "./ACTElement.h"
 #include "./BitVectorIterator.h"
 #include "./DSMEBitVector.h"
@@ -58,8 +59,16 @@
 
 using namespace dsme;
 
+template <typename T, typename K>
+static void removeAll(RBTree<T, K>& tree) {
+    while(tree.size() != 0) {
+        auto it = tree.begin();
+        tree.remove(it);
+    }
+}
+
 DSMEAllocationCounterTable::DSMEAllocationCounterTable()
-    : numSuperFramesPerMultiSuperframe(0), numGTSlotsFirstSuperframe(0), numGTSlotsLatterSuperframes(0), numChannels(0) {
+    : numSuperFramesPerMultiSuperframe(0), numGTSlotsFirstSuperframe(0), numGTSlotsLatterSuperframes(0), numChannels(0), multiSuperframeCounter(0) {
 }
 
 void DSMEAllocationCounterTable::initialize(uint16_t numSuperFramesPerMultiSuperframe, uint8_t numGTSlotsFirstSuperframe, uint8_t numGTSlotsLatterSuperframes,
@@ -80,6 +89,27 @@ uint16_t DSMEAllocationCounterTable::getBitmapPosition(uint8_t superframeID, uin
     }
 }
 
+/* position of the slot in the multi-superframe in units of superframe slots, so the CAP lies between the GTS of consecutive superframes */
+uint16_t DSMEAllocationCounterTable::getSlotTime(uint16_t bitmapPosition) const {
+    if(bitmapPosition < numGTSlotsFirstSuperframe) {
+        return (aNumSuperframeSlots - numGTSlotsFirstSuperframe) + bitmapPosition;
+    }
+    bitmapPosition -= numGTSlotsFirstSuperframe;
+    uint16_t superframeID = 1 + bitmapPosition / numGTSlotsLatterSuperframes;
+    return superframeID * aNumSuperframeSlots + (aNumSuperframeSlots - numGTSlotsLatterSuperframes) + bitmapPosition % numGTSlotsLatterSuperframes;
+}
+
+void DSMEAllocationCounterTable::getSlotPosition(uint16_t bitmapPosition, uint16_t& superframeID, uint8_t& gtSlotID) const {
+    if(bitmapPosition < numGTSlotsFirstSuperframe) {
+        superframeID = 0;
+        gtSlotID = bitmapPosition;
+    } else {
+        bitmapPosition -= numGTSlotsFirstSuperframe;
+        superframeID = 1 + bitmapPosition / numGTSlotsLatterSuperframes;
+        gtSlotID = bitmapPosition % numGTSlotsLatterSuperframes;
+    }
+}
+
 DSMEAllocationCounterTable::iterator DSMEAllocationCounterTable::begin() {
     return act.begin();
 }
@@ -89,18 +119,17 @@ DSMEAllocationCounterTable::iterator DSMEAllocationCounterTable::end() {
 }
 
 void DSMEAllocationCounterTable::clear() {
-    while(this->act.size() != 0) {
-        auto it = this->act.begin();
-        this->act.remove(it);
-    }
+    removeAll(this->act);
 
     for(int i = 0; i < 2; i++) {
-        while(this->numAllocatedSlots[i].size() != 0) {
-            auto it = this->numAllocatedSlots[i].begin();
-            this->numAllocatedSlots[i].remove(it);
-        }
+        removeAll(this->numAllocatedSlots[i]);
     }
 
+    removeAll(this->expirationQueue);
+    removeAll(this->expiredSlots);
+    removeAll(this->invalidSlots);
+    removeAll(this->unconfirmedSlots);
+
     this->bitmap.fill(false);
 }
 
@@ -139,7 +168,7 @@ bool DSMEAllocationCounterTable::add(uint16_t superframeID, uint8_t gtSlotID, ui
     ACTPosition pos;
     pos.superframeID = superframeID;
     pos.gtSlotID = gtSlotID;
-    bool success = act.insert(ACTElement(superframeID, gtSlotID, channel, direction, address, state), pos);
+    bool success = act.insert(ACTElement(superframeID, gtSlotID, channel, direction, address, state, &multiSuperframeCounter), pos);
 
     if(success) {
         this->dsme->getPlatform().signalGTSChange(false, IEEE802154MacAddress(address));
@@ -155,6 +184,15 @@ bool DSMEAllocationCounterTable::add(uint16_t superframeID, uint8_t gtSlotID, ui
         }
 
         bitmap.set(getBitmapPosition(superframeID, gtSlotID), true);
+
+        registerState(pos, state);
+        if(direction == Direction::RX) {
+            enqueueExpiration(pos, multiSuperframeCounter);
+        }
+
+        if(allocationChangedDelegate) {
+            allocationChangedDelegate(address, direction);
+        }
     }
 
     return success;
@@ -183,7 +221,23 @@ void DSMEAllocationCounterTable::remove(DSMEAllocationCounterTable::iterator it)
         numAllocatedSlots[d].remove(numSlotIt);
     }
 
+    // The entry in the expiration queue is dropped lazily once it reaches the head of the queue
+    ACTPosition pos;
+    pos.superframeID = superframeID;
+    pos.gtSlotID = gtSlotID;
+    unregisterState(pos, it->state);
+    RBTree<ACTPosition, ACTPosition>::iterator expiredIt = expiredSlots.find(pos);
+    if(expiredIt != expiredSlots.end()) {
+        expiredSlots.remove(expiredIt);
+    }
+
+    uint16_t address = it->address;
+    Direction direction = it->direction;
     act.remove(it);
+
+    if(allocationChangedDelegate) {
+        allocationChangedDelegate(address, direction);
+    }
 }
 
 bool DSMEAllocationCounterTable::isAllocated(uint16_t superframeID, uint8_t gtSlotID) const {
@@ -201,6 +255,101 @@ uint16_t DSMEAllocationCounterTable::getNumAllocatedGTS(uint16_t address, Direct
     }
 }
 
+bool DSMEAllocationCounterTable::getSpreadSlot(uint16_t address, Direction direction, uint16_t& superframeID, uint8_t& gtSlotID) {
+    if(getNumAllocatedGTS(address, direction) == 0) {
+        return false;
+    }
+
+    BitVector<MAX_SUPERFRAMES_PER_MULTI_SUPERFRAME * MAX_GTSLOTS> linkSlots;
+    linkSlots.initialize(bitmap.length(), false);
+    for(iterator it = act.begin(); it != act.end(); ++it) {
+        if(it->getAddress() == address && it->getDirection() == direction) {
+            linkSlots.set(getBitmapPosition(it->getSuperframeID(), it->getGTSlotID()), true);
+        }
+    }
+
+    const uint16_t multiSuperframeLength = numSuperFramesPerMultiSuperframe * aNumSuperframeSlots;
+    uint16_t bestDistance = 0;
+    uint16_t bestPosition = 0;
+    for(BitVectorIterator candidate = bitmap.beginUnsetBits(); candidate != bitmap.endUnsetBits(); ++candidate) {
+        uint16_t time = getSlotTime(*candidate);
+
+        /* cyclic distance to the closest slot of the link */
+        uint16_t distance = multiSuperframeLength;
+        for(BitVectorIterator used = linkSlots.beginSetBits(); used != linkSlots.endSetBits(); ++used) {
+            uint16_t usedTime = getSlotTime(*used);
+            uint16_t d = (time > usedTime) ? time - usedTime : usedTime - time;
+            if(multiSuperframeLength - d < d) {
+                d = multiSuperframeLength - d;
+            }
+            if(d < distance) {
+                distance = d;
+            }
+        }
+
+        if(distance > bestDistance) {
+            bestDistance = distance;
+            bestPosition = *candidate;
+        }
+    }
+
+    if(bestDistance == 0) {
+        return false;
+    }
+
+    getSlotPosition(bestPosition, superframeID, gtSlotID);
+    return true;
+}
+
+bool DSMEAllocationCounterTable::getSlotFollowingRx(uint16_t txAddress, uint16_t& superframeID, uint8_t& gtSlotID) {
+    BitVector<MAX_SUPERFRAMES_PER_MULTI_SUPERFRAME * MAX_GTSLOTS> txSlots;
+    txSlots.initialize(bitmap.length(), false);
+    for(iterator it = act.begin(); it != act.end(); ++it) {
+        if(it->getAddress() == txAddress && it->getDirection() == Direction::TX) {
+            txSlots.set(getBitmapPosition(it->getSuperframeID(), it->getGTSlotID()), true);
+        }
+    }
+
+    const uint16_t multiSuperframeLength = numSuperFramesPerMultiSuperframe * aNumSuperframeSlots;
+    uint16_t longestWait = 0;
+    uint16_t bestPosition = 0;
+    for(iterator it = act.begin(); it != act.end(); ++it) {
+        if(it->getDirection() != Direction::RX || it->getAddress() == txAddress) {
+            continue;
+        }
+
+        uint16_t rxPosition = getBitmapPosition(it->getSuperframeID(), it->getGTSlotID());
+        uint16_t followingPosition = (rxPosition + 1) % bitmap.length();
+        if(txSlots.get(followingPosition)) {
+            /* '-> the received frames are forwarded right away */
+            continue;
+        }
+
+        /* time until the next TX slot, a full multi-superframe if there is none */
+        uint16_t rxTime = getSlotTime(rxPosition);
+        uint16_t wait = multiSuperframeLength;
+        for(BitVectorIterator tx = txSlots.beginSetBits(); tx != txSlots.endSetBits(); ++tx) {
+            uint16_t txTime = getSlotTime(*tx);
+            uint16_t w = (txTime > rxTime) ? txTime - rxTime : multiSuperframeLength - (rxTime - txTime);
+            if(w < wait) {
+                wait = w;
+            }
+        }
+
+        if(wait > longestWait) {
+            longestWait = wait;
+            bestPosition = followingPosition;
+        }
+    }
+
+    if(longestWait == 0) {
+        return false;
+    }
+
+    getSlotPosition(bestPosition, superframeID, gtSlotID);
+    return true;
+}
+
 void DSMEAllocationCounterTable::setACTStateIfExists(DSMESABSpecification& subBlock, ACTState state, uint16_t channelOffset) {
     Direction ignoredDirection = TX;
     setACTState(subBlock, state, ignoredDirection, 0xFFFF, channelOffset, false);
@@ -230,12 +379,8 @@ void DSMEAllocationCounterTable::setACTState(DSMESABSpecification& subBlock, ACT
 
 void DSMEAllocationCounterTable::setACTState(DSMESABSpecification& subBlock, ACTState state, Direction direction, uint16_t deviceAddress,
                                              uint16_t channelOffset, bool useChannelOffset, condition_t condition, bool checkAddress) {
-    // Supporting more than one slot allocation induces many open issues and is probably not needed most of the time.
-    if(subBlock.getSubBlock().count(true) < 1) {
-        return;
-    }
-    DSME_ASSERT(subBlock.getSubBlock().count(true) == 1);
-
+    // Every slot of the sub-block is handled on its own, so slots that are already in use by another device or on
+    // another channel are skipped while the remaining slots of a multi-slot allocation are still applied.
     for(DSMESABSpecification::SABSubBlock::iterator it = subBlock.getSubBlock().beginSetBits(); it != subBlock.getSubBlock().endSetBits(); ++it) {
         // this calculation assumes there is always exactly one superframe in the subblock
         GTS gts(subBlock.getSubBlockIndex(), (*it) / numChannels, (*it) % numChannels);
@@ -283,7 +428,192 @@ void DSMEAllocationCounterTable::setACTState(DSMESABSpecification& subBlock, ACT
         } else {
             LOG_DEBUG("set slot " << (uint16_t)actit->getGTSlotID() << " " << (uint16_t)actit->getSuperframeID() << " " << (uint16_t)actit->getChannel()
                                   << " to " << stateToString(state));
-            actit->setState(state);
+            setState(actit, state);
+        }
+    }
+}
+
+void DSMEAllocationCounterTable::startMultiSuperframe() {
+    multiSuperframeCounter++;
+
+    // The queue is ordered by the last activity, so only the head has to be inspected
+    while(true) {
+        RBTree<ACTPosition, ExpirationKey>::iterator head = expirationQueue.min();
+        if(head == expirationQueue.end() || multiSuperframeCounter - head.node()->key.lastActivity <= dsme->getMAC_PIB().macDSMEGTSExpirationTime) {
+            break;
         }
+
+        ACTPosition position = *head;
+        expirationQueue.remove(head);
+
+        iterator it = act.find(position);
+        if(it == act.end() || it->getDirection() != Direction::RX) {
+            /* '-> slot was removed in the meantime */
+            continue;
+        }
+
+        if(isExpired(*it)) {
+            expiredSlots.insert(position, position);
+        } else {
+            /* '-> received something in the meantime, the queue entry was outdated */
+            enqueueExpiration(position, it->getLastActivity());
+        }
+    }
+}
+
+void DSMEAllocationCounterTable::incrementIdleCounter(iterator it) {
+    DSME_ASSERT(it != act.end());
+    it->incrementIdleCounter();
+
+    if(it->getDirection() == Direction::TX && isExpired(*it)) {
+        ACTPosition pos;
+        pos.superframeID = it->getSuperframeID();
+        pos.gtSlotID = it->getGTSlotID();
+        expiredSlots.insert(pos, pos);
+    }
+}
+
+uint8_t DSMEAllocationCounterTable::getSlotsToDeallocate(DSMESABSpecification& subBlock, uint16_t& address, Direction& direction, bool includeUnconfirmed) {
+    cleanUpExpiredSlots();
+
+    RBTree<ACTPosition, ACTPosition>* candidates[] = {&invalidSlots, includeUnconfirmed ? &unconfirmedSlots : nullptr, &expiredSlots};
+
+    iterator first = act.end();
+    for(RBTree<ACTPosition, ACTPosition>* slots : candidates) {
+        if(slots == nullptr) {
+            continue;
+        }
+        for(RBTree<ACTPosition, ACTPosition>::iterator it = slots->begin(); it != slots->end(); ++it) {
+            iterator element = act.find(*it);
+            DSME_ASSERT(element != act.end());
+            if(slots != &expiredSlots || includeUnconfirmed || element->getState() != UNCONFIRMED) {
+                first = element;
+                break;
+            }
+        }
+        if(first != act.end()) {
+            break;
+        }
+    }
+
+    if(first == act.end()) {
+        return 0;
+    }
+
+    address = first->getAddress();
+    direction = first->getDirection();
+    subBlock.setSubBlockLengthBytes(dsme->getMAC_PIB().helper.getSubBlockLengthBytes(first->getSuperframeID()));
+    subBlock.setSubBlockIndex(first->getSuperframeID());
+    subBlock.getSubBlock().fill(false);
+
+    uint8_t numSlots = 0;
+    for(RBTree<ACTPosition, ACTPosition>* slots : candidates) {
+        if(slots != nullptr) {
+            numSlots += collectSlotsToDeallocate(*slots, subBlock, address, direction, includeUnconfirmed);
+        }
+    }
+
+    // The idle counters of the collected expired slots were reset, so they are no longer expired
+    cleanUpExpiredSlots();
+
+    return numSlots;
+}
+
+void DSMEAllocationCounterTable::setState(iterator it, ACTState state) {
+    ACTPosition pos;
+    pos.superframeID = it->getSuperframeID();
+    pos.gtSlotID = it->getGTSlotID();
+
+    unregisterState(pos, it->getState());
+    it->setState(state);
+    registerState(pos, state);
+}
+
+void DSMEAllocationCounterTable::registerState(ACTPosition& position, ACTState state) {
+    if(state == INVALID) {
+        invalidSlots.insert(position, position);
+    } else if(state == UNCONFIRMED) {
+        unconfirmedSlots.insert(position, position);
+    }
+}
+
+void DSMEAllocationCounterTable::unregisterState(ACTPosition& position, ACTState state) {
+    RBTree<ACTPosition, ACTPosition>* slots;
+    if(state == INVALID) {
+        slots = &invalidSlots;
+    } else if(state == UNCONFIRMED) {
+        slots = &unconfirmedSlots;
+    } else {
+        return;
+    }
+
+    RBTree<ACTPosition, ACTPosition>::iterator it = slots->find(position);
+    if(it != slots->end()) {
+        slots->remove(it);
+    }
+}
+
+void DSMEAllocationCounterTable::enqueueExpiration(ACTPosition& position, uint32_t lastActivity) {
+    ExpirationKey key;
+    key.lastActivity = lastActivity;
+    key.position = position;
+    expirationQueue.insert(position, key);
+}
+
+bool DSMEAllocationCounterTable::isExpired(ACTElement& element) const {
+    return element.getIdleCounter() > dsme->getMAC_PIB().macDSMEGTSExpirationTime;
+}
+
+void DSMEAllocationCounterTable::cleanUpExpiredSlots() {
+    // Receptions or resets of the idle counter do not update the expired slots, so drop the outdated ones here
+    bool removed = true;
+    while(removed) {
+        removed = false;
+        for(RBTree<ACTPosition, ACTPosition>::iterator it = expiredSlots.begin(); it != expiredSlots.end(); ++it) {
+            ACTPosition position = *it;
+            iterator element = act.find(position);
+            if(element == act.end() || !isExpired(*element)) {
+                expiredSlots.remove(it);
+                if(element != act.end() && element->getDirection() == Direction::RX) {
+                    enqueueExpiration(position, element->getLastActivity());
+                }
+                removed = true;
+                break;
+            }
+        }
+    }
+}
+
+uint8_t DSMEAllocationCounterTable::collectSlotsToDeallocate(RBTree<ACTPosition, ACTPosition>& slots, DSMESABSpecification& subBlock, uint16_t address,
+                                                              Direction direction, bool includeUnconfirmed) {
+    uint8_t numSlots = 0;
+    for(RBTree<ACTPosition, ACTPosition>::iterator it = slots.begin(); it != slots.end(); ++it) {
+        iterator element = act.find(*it);
+        DSME_ASSERT(element != act.end());
+
+        if(element->getAddress() != address || element->getDirection() != direction || element->getSuperframeID() != subBlock.getSubBlockIndex()) {
+            continue;
+        }
+
+        if(!includeUnconfirmed && element->getState() == UNCONFIRMED) {
+            continue;
+        }
+
+        uint16_t bit = element->getGTSlotID() * numChannels + element->getChannel();
+        if(subBlock.getSubBlock().get(bit)) {
+            /* '-> already collected for another reason */
+            continue;
+        }
+
+        if(&slots == &expiredSlots) {
+            element->resetIdleCounter();
+            LOG_INFO("DEALLOCATE: Due to expiration");
+        } else {
+            LOG_INFO("DEALLOCATE: Due to state " << stateToString(element->getState()));
+        }
+
+        subBlock.getSubBlock().set(bit, true);
+        numSlots++;
     }
+    return numSlots;
 }
@@ -44,6 +44,7 @@
 #define DSMEALLOCATIONCOUNTERTABLE_H_
 
 #include "../../../dsme_settings.h"
+#include "../../helper/DSMEDelegate.h"
 #include "../../interfaces/IDSMEPlatform.h"
 #include "./ACTElement.h"
 #include "./DSMEBitVector.h"
@@ -81,6 +82,30 @@ struct ACTPosition {
     }
 };
 
+// Orders the expiration queue by the multi-superframe of the last activity
+struct ExpirationKey {
+    uint32_t lastActivity;
+    ACTPosition position;
+
+    bool operator>(const ExpirationKey& other) const {
+        if(this->lastActivity != other.lastActivity) {
+            return this->lastActivity > other.lastActivity;
+        }
+        return this->position > other.position;
+    }
+
+    bool operator<(const ExpirationKey& other) const {
+        if(this->lastActivity != other.lastActivity) {
+            return this->lastActivity < other.lastActivity;
+        }
+        return this->position < other.position;
+    }
+
+    bool operator==(const ExpirationKey& other) const {
+        return ((lastActivity == other.lastActivity) && (position == other.position));
+    }
+};
+
 class DSMELayer;
 
 // own allocated slots
@@ -112,15 +137,69 @@ public:
 
     uint16_t getNumAllocatedGTS(uint16_t address, Direction direction);
 
+    /**
+     * Finds the unallocated slot with the largest distance to the closest slot already allocated with the given link.
+     * Slots placed this way spread evenly over the multi-superframe, which minimizes the time a frame waits for the next slot.
+     *
+     * @return false if no slot is allocated with the link yet or all slots are allocated
+     */
+    bool getSpreadSlot(uint16_t address, Direction direction, uint16_t& superframeID, uint8_t& gtSlotID);
+
+    /**
+     * Finds the RX slot whose frames wait longest for the next TX slot to the given address (e.g. the parent in a convergecast tree)
+     * and returns the slot position directly following it. RX slots that are already followed by such a TX slot are skipped.
+     *
+     * @return false if there is no RX slot with another device or all of them are followed by a TX slot
+     */
+    bool getSlotFollowingRx(uint16_t txAddress, uint16_t& superframeID, uint8_t& gtSlotID);
+
     void setACTState(DSMESABSpecification& subBlock, ACTState state, Direction direction, uint16_t deviceAddress, uint16_t channelOffset, bool useChannelOffset,
                      bool checkAddress = false);
     void setACTState(DSMESABSpecification& subBlock, ACTState state, Direction direction, uint16_t deviceAddress, uint16_t channelOffset, bool useChannelOffset,
                      condition_t condition, bool checkAddress = false);
     void setACTStateIfExists(DSMESABSpecification& subBlock, ACTState state, uint16_t channelOffset);
 
+    /**
+     * Advances the multi-superframe counter the idle counters of the RX slots are based on (5.1.10.5.3).
+     * Only the RX slots at the head of the expiration queue are inspected.
+     */
+    void startMultiSuperframe();
+
+    /**
+     * Increments the idle counter of a TX slot and registers the slot for deallocation once it exceeds macDSMEGTSExpirationTime.
+     */
+    void incrementIdleCounter(iterator it);
+
+    /**
+     * Collects the slots to be deallocated, i.e. INVALID, UNCONFIRMED (only if includeUnconfirmed) or expired ones.
+     * Only the slots registered for one of these reasons are inspected, not the whole table.
+     * All collected slots belong to the link and superframe of the first one, the idle counters of expired slots are reset.
+     *
+     * @return the number of slots in the sub block, 0 if there is nothing to deallocate
+     */
+    uint8_t getSlotsToDeallocate(DSMESABSpecification& subBlock, uint16_t& address, Direction& direction, bool includeUnconfirmed);
+
+    /**
+     * Called after a slot was added or removed, e.g. to keep the priorities of the scheduling up to date.
+     */
+    void setAllocationChangedDelegate(Delegate<void(uint16_t, Direction)> delegate) {
+        allocationChangedDelegate = delegate;
+    }
+
 private:
     DSMEAllocationCounterTable(const DSMEAllocationCounterTable& other) = delete;
     uint16_t getBitmapPosition(uint8_t superframeID, uint8_t slotID) const;
+    uint16_t getSlotTime(uint16_t bitmapPosition) const;
+    void getSlotPosition(uint16_t bitmapPosition, uint16_t& superframeID, uint8_t& gtSlotID) const;
+
+    void setState(iterator it, ACTState state);
+    void registerState(ACTPosition& position, ACTState state);
+    void unregisterState(ACTPosition& position, ACTState state);
+    void enqueueExpiration(ACTPosition& position, uint32_t lastActivity);
+    bool isExpired(ACTElement& element) const;
+    void cleanUpExpiredSlots();
+    uint8_t collectSlotsToDeallocate(RBTree<ACTPosition, ACTPosition>& slots, DSMESABSpecification& subBlock, uint16_t address, Direction direction,
+                                     bool includeUnconfirmed);
 
     uint16_t numSuperFramesPerMultiSuperframe;
     uint8_t numGTSlotsFirstSuperframe;
@@ -133,6 +212,14 @@ private:
     // TODO integrate this nicely into the NeighborQueue
     RBTree<uint16_t, uint16_t> numAllocatedSlots[2]; // 0 == TX, 1 == RX
 
+    uint32_t multiSuperframeCounter;
+    RBTree<ACTPosition, ExpirationKey> expirationQueue; // RX slots, entries get outdated by receptions and are fixed lazily
+    RBTree<ACTPosition, ACTPosition> expiredSlots;
+    RBTree<ACTPosition, ACTPosition> invalidSlots;
+    RBTree<ACTPosition, ACTPosition> unconfirmedSlots;
+
+    Delegate<void(uint16_t, Direction)> allocationChangedDelegate;
+
     DSMELayer* dsme;
 };
 
@@ -45,11 +45,12 @@
 #include "./DSMEBitVector.h"
 #include "./DSMESABSpecification.h"
 #include "./GTS.h"
+#include "./IEEE802154MacAddress.h"
 
 namespace dsme {
 
 DSMESlotAllocationBitmap::DSMESlotAllocationBitmap()
-    : numSuperframesPerMultiSuperframe(0), numGTSlotsFirstSuperframe(0), numGTSlotsLatterSuperframes(0), numChannels(0) {
+    : numUsers{}, lastLink{}, numSuperframesPerMultiSuperframe(0), numGTSlotsFirstSuperframe(0), numGTSlotsLatterSuperframes(0), numChannels(0) {
 }
 
 void DSMESlotAllocationBitmap::initialize(uint16_t numSuperframesPerMultiSuperframe, uint8_t numGTSlotsFirstSuperframe, uint8_t numGTSlotsLatterSuperframes,
@@ -59,11 +60,18 @@ void DSMESlotAllocationBitmap::initialize(uint16_t numSuperframesPerMultiSuperfr
     this->numGTSlotsLatterSuperframes = numGTSlotsLatterSuperframes;
     this->numChannels = numChannels;
     occupied.initialize((numGTSlotsFirstSuperframe + (numSuperframesPerMultiSuperframe - 1) * numGTSlotsLatterSuperframes) * numChannels);
+    lastAdded.initialize(occupied.length());
+    clear();
     return;
 }
 
 void DSMESlotAllocationBitmap::clear() {
     occupied.fill(false);
+    lastAdded.fill(false);
+    for(abs_slot_idx_t idx = 0; idx < occupied.length(); idx++) {
+        numUsers[idx] = 0;
+        lastLink[idx] = IEEE802154MacAddress::NO_SHORT_ADDRESS;
+    }
 }
 
 uint16_t DSMESlotAllocationBitmap::getSubblockOffset(uint8_t subBlockIndex) const {
@@ -74,13 +82,56 @@ uint16_t DSMESlotAllocationBitmap::getSubblockOffset(uint8_t subBlockIndex) cons
     }
 }
 
-void DSMESlotAllocationBitmap::addOccupiedSlots(const DSMESABSpecification& subBlock) {
-    occupied.setOperationJoin(subBlock.getSubBlock(), getSubblockOffset(subBlock.getSubBlockIndex()));
+bool DSMESlotAllocationBitmap::updateLastLink(abs_slot_idx_t idx, uint16_t linkId, bool added) {
+    if(lastLink[idx] == linkId && lastAdded.get(idx) == added) {
+        /* '-> reply and notify of the same handshake were both overheard */
+        return false;
+    }
+    lastLink[idx] = linkId;
+    lastAdded.set(idx, added);
+    return true;
+}
+
+void DSMESlotAllocationBitmap::addOccupiedSlots(const DSMESABSpecification& subBlock, uint16_t source, uint16_t destination) {
+    uint16_t offset = getSubblockOffset(subBlock.getSubBlockIndex());
+    uint16_t linkId = getLinkId(source, destination);
+    DSMESABSpecification::SABSubBlock slots = subBlock.getSubBlock();
+    for(DSMESABSpecification::SABSubBlock::iterator it = slots.beginSetBits(); it != slots.endSetBits(); ++it) {
+        abs_slot_idx_t idx = offset + *it;
+        if(updateLastLink(idx, linkId, true) && numUsers[idx] < UINT8_MAX) {
+            numUsers[idx]++;
+        }
+        occupied.set(idx, true);
+    }
+    return;
+}
+
+void DSMESlotAllocationBitmap::removeOccupiedSlots(const DSMESABSpecification& subBlock, uint16_t source, uint16_t destination) {
+    uint16_t offset = getSubblockOffset(subBlock.getSubBlockIndex());
+    uint16_t linkId = getLinkId(source, destination);
+    DSMESABSpecification::SABSubBlock slots = subBlock.getSubBlock();
+    for(DSMESABSpecification::SABSubBlock::iterator it = slots.beginSetBits(); it != slots.endSetBits(); ++it) {
+        abs_slot_idx_t idx = offset + *it;
+        if(updateLastLink(idx, linkId, false) && numUsers[idx] > 0) {
+            numUsers[idx]--;
+        }
+        if(numUsers[idx] == 0) {
+            occupied.set(idx, false);
+        }
+    }
     return;
 }
 
-void DSMESlotAllocationBitmap::removeOccupiedSlots(const DSMESABSpecification& subBlock) {
-    occupied.setOperationComplement(subBlock.getSubBlock(), getSubblockOffset(subBlock.getSubBlockIndex()));
+void DSMESlotAllocationBitmap::markOccupiedSlots(const DSMESABSpecification& subBlock) {
+    uint16_t offset = getSubblockOffset(subBlock.getSubBlockIndex());
+    DSMESABSpecification::SABSubBlock slots = subBlock.getSubBlock();
+    for(DSMESABSpecification::SABSubBlock::iterator it = slots.beginSetBits(); it != slots.endSetBits(); ++it) {
+        abs_slot_idx_t idx = offset + *it;
+        if(numUsers[idx] == 0) {
+            numUsers[idx] = 1;
+        }
+        occupied.set(idx, true);
+    }
     return;
 }
 
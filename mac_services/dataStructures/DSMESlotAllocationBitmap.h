@@ -71,21 +71,39 @@ public:
     void getOccupiedChannels(BitVector<MAX_CHANNELS>& channelVector, uint16_t subBlockIndex, uint16_t subBlockOffset) const;
 
     /**
-     * Update slot occupation of neighborhood on receipt of reply/notify
+     * Update slot occupation of neighborhood on receipt of reply/notify of the link between source and destination.
+     * Every link adds one user to the given slots, so a slot shared by several links stays occupied until all of them are removed.
+     * The reply and the notify of the same handshake are only counted once.
      */
-    void addOccupiedSlots(const DSMESABSpecification& subBlock);
+    void addOccupiedSlots(const DSMESABSpecification& subBlock, uint16_t source, uint16_t destination);
 
     /**
-     * Update slot occupation of neighborhood on receipt of reply/notify
+     * Update slot occupation of neighborhood on receipt of reply/notify, removes the link between source and destination from the given slots
      */
-    void removeOccupiedSlots(const DSMESABSpecification& subBlock);
+    void removeOccupiedSlots(const DSMESABSpecification& subBlock, uint16_t source, uint16_t destination);
+
+    /**
+     * Marks the slots as occupied without adding another user to slots that are already occupied (e.g. on a duplicate allocation notification)
+     */
+    void markOccupiedSlots(const DSMESABSpecification& subBlock);
 
     bool isOccupied(abs_slot_idx_t idx);
 
 private:
     uint16_t getSubblockOffset(uint8_t subBlockIndex) const;
 
-    BitVector<MAX_OCCUPIED_SLOTS> occupied; // occupied by neighbors
+    /* a device can only take part in one link per slot, so either of its devices identifies the link */
+    static uint16_t getLinkId(uint16_t source, uint16_t destination) {
+        return source < destination ? source : destination;
+    }
+
+    /* returns false if the slot was already updated for this link in the same way, i.e. the message belongs to the same handshake */
+    bool updateLastLink(abs_slot_idx_t idx, uint16_t linkId, bool added);
+
+    BitVector<MAX_OCCUPIED_SLOTS> occupied;  // occupied by neighbors, derived from numUsers for fast extraction of sub blocks
+    BitVector<MAX_OCCUPIED_SLOTS> lastAdded; // if the last update of the slot added the link lastLink
+    uint8_t numUsers[MAX_OCCUPIED_SLOTS];     // number of overheard links using the slot
+    uint16_t lastLink[MAX_OCCUPIED_SLOTS];    // link of the last reply/notify that updated the slot
     uint16_t numSuperframesPerMultiSuperframe;
     uint8_t numGTSlotsFirstSuperframe;
     uint8_t numGTSlotsLatterSuperframes;
@@ -0,0 +1,175 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef GROUPACKWINDOW_H_
+#define GROUPACKWINDOW_H_
+
+#include "../../../dsme_settings.h"
+#include "../../helper/Integers.h"
+
+namespace dsme {
+
+/*
+ * Remembers the sequence numbers recently received from each neighbor during its GTSs.
+ * The group ACK is built from it for the original sequence numbers of the frames, and retransmissions of frames
+ * that were already delivered (i.e. the group ACK was lost) are detected as duplicates.
+ */
+class GroupAckWindow {
+public:
+    /* number of sequence numbers remembered per neighbor, counted back from the highest one */
+    static constexpr uint8_t WINDOW_SIZE = 32;
+
+    GroupAckWindow() : entries{}, numEntries(0), nextReplaced(0) {
+    }
+
+    void clear() {
+        this->numEntries = 0;
+        this->nextReplaced = 0;
+    }
+
+    /**
+     * Records a received sequence number of a neighbor
+     * The sequence numbers of a neighbor are shared with all its other transmissions, so the entry is only compared against
+     * if the last frame was received at most maxAge symbols ago, e.g. one GTS period of the link.
+     * @param now symbol counter at the reception
+     * @return false if the sequence number was already received, i.e. the frame is a duplicate
+     */
+    bool record(uint16_t address, uint8_t sequenceNumber, uint32_t now, uint32_t maxAge) {
+        Entry* entry = find(address);
+        if(entry != nullptr && now - entry->lastReception <= maxAge) {
+            entry->lastReception = now;
+            return recordRecent(entry, sequenceNumber);
+        }
+
+        /* '-> unknown neighbor, or it might have used up all its sequence numbers since its last frame to us */
+        if(entry == nullptr) {
+            entry = add(address);
+        }
+        entry->lastReception = now;
+        entry->highest = sequenceNumber;
+        entry->received = 1;
+        return true;
+    }
+
+    /**
+     * @return bitmap in the format of the GroupAckCmd, bit i is set if baseSequenceNumber + i was received
+     */
+    uint16_t getBitmap(uint16_t address, uint8_t baseSequenceNumber, uint8_t windowSize) {
+        Entry* entry = find(address);
+        uint16_t bitmap = 0;
+        if(entry == nullptr) {
+            return bitmap;
+        }
+
+        for(uint8_t i = 0; i < windowSize; i++) {
+            uint8_t behind = entry->highest - (uint8_t)(baseSequenceNumber + i);
+            if(behind < WINDOW_SIZE && (entry->received & ((uint32_t)1 << behind))) {
+                bitmap |= (1 << i);
+            }
+        }
+        return bitmap;
+    }
+
+private:
+    struct Entry {
+        uint16_t address;
+        uint8_t highest;
+
+        /* bit i is set if the sequence number highest - i was received */
+        uint32_t received;
+
+        /* symbol counter of the last recorded frame */
+        uint32_t lastReception;
+    };
+
+    bool recordRecent(Entry* entry, uint8_t sequenceNumber) {
+        uint8_t ahead = sequenceNumber - entry->highest;
+        if(ahead != 0 && ahead < 128) {
+            /* '-> newer than all frames received before */
+            entry->received = (ahead >= WINDOW_SIZE) ? 0 : (entry->received << ahead);
+            entry->received |= 1;
+            entry->highest = sequenceNumber;
+            return true;
+        }
+
+        uint8_t behind = entry->highest - sequenceNumber;
+        if(behind >= WINDOW_SIZE) {
+            /* '-> too old to be known, handled as new frame */
+            return true;
+        }
+
+        uint32_t bit = (uint32_t)1 << behind;
+        bool duplicate = entry->received & bit;
+        entry->received |= bit;
+        return !duplicate;
+    }
+
+    Entry* find(uint16_t address) {
+        for(uint8_t i = 0; i < this->numEntries; i++) {
+            if(this->entries[i].address == address) {
+                return &this->entries[i];
+            }
+        }
+        return nullptr;
+    }
+
+    Entry* add(uint16_t address) {
+        Entry* entry;
+        if(this->numEntries < MAX_NEIGHBORS) {
+            entry = &this->entries[this->numEntries++];
+        } else {
+            /* '-> replace the entries in turn */
+            entry = &this->entries[this->nextReplaced];
+            this->nextReplaced = (this->nextReplaced + 1) % MAX_NEIGHBORS;
+        }
+        entry->address = address;
+        return entry;
+    }
+
+    Entry entries[MAX_NEIGHBORS];
+    uint8_t numEntries;
+    uint8_t nextReplaced;
+};
+
+} /* namespace dsme */
+
+#endif /* GROUPACKWINDOW_H_ */
@@ -0,0 +1,143 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "./LinkCapacityTable.h"
+
+#include "../../../dsme_platform.h"
+
+namespace dsme {
+
+constexpr uint16_t LinkCapacityTable::ATTEMPTS_ONE;
+
+LinkCapacityTable::iterator LinkCapacityTable::begin() {
+    return table.begin();
+}
+
+LinkCapacityTable::iterator LinkCapacityTable::end() {
+    return table.end();
+}
+
+void LinkCapacityTable::clear() {
+    while(this->table.size() != 0) {
+        auto it = this->table.begin();
+        this->table.remove(it);
+    }
+}
+
+LinkCapacityTable::iterator LinkCapacityTable::findOrInsert(uint16_t address) {
+    iterator it = this->table.find(address);
+    if(it == this->table.end()) {
+        if(this->table.size() >= MAX_ENTRIES) {
+            LOG_DEBUG("LinkCapacityTable full, dropping sample for 0x" << HEXOUT << address << DECOUT);
+            return this->table.end();
+        }
+
+        LinkCapacityEntry entry{address, 0, 0, 0, 0};
+        this->table.insert(entry, address);
+        it = this->table.find(address);
+        DSME_ASSERT(it != this->table.end());
+    }
+    return it;
+}
+
+void LinkCapacityTable::updateAttempt(uint16_t address, uint32_t duration) {
+    iterator it = findOrInsert(address);
+    if(it == this->table.end()) {
+        return;
+    }
+
+    if(duration > 0xFFFF) {
+        duration = 0xFFFF;
+    }
+
+    if(it->numAttemptSamples == 0) {
+        it->avgAttemptDuration = duration;
+    } else {
+        it->avgAttemptDuration = it->avgAttemptDuration - (it->avgAttemptDuration >> EWMA_SHIFT) + (duration >> EWMA_SHIFT);
+    }
+    if(it->numAttemptSamples < 0xFFFF) {
+        it->numAttemptSamples++;
+    }
+}
+
+void LinkCapacityTable::updateSaturatedSlot(uint16_t address, uint8_t numAttempts) {
+    iterator it = findOrInsert(address);
+    if(it == this->table.end()) {
+        return;
+    }
+
+    uint16_t sample = numAttempts * ATTEMPTS_ONE;
+    if(it->numSlotSamples == 0) {
+        it->avgAttemptsPerSlot = sample;
+    } else {
+        it->avgAttemptsPerSlot = it->avgAttemptsPerSlot - (it->avgAttemptsPerSlot >> EWMA_SHIFT) + (sample >> EWMA_SHIFT);
+    }
+    if(it->numSlotSamples < 0xFFFF) {
+        it->numSlotSamples++;
+    }
+}
+
+uint8_t LinkCapacityTable::getAttemptsPerSlot(uint16_t address, uint32_t usableSymbols, uint8_t defaultValue) {
+    iterator it = this->table.find(address);
+    if(it == this->table.end()) {
+        return defaultValue;
+    }
+
+    uint32_t attempts;
+    if(it->numSlotSamples >= MIN_SLOT_SAMPLES) {
+        /* '-> the slots were observed to run out of time, that already includes all processing delays */
+        attempts = (it->avgAttemptsPerSlot + ATTEMPTS_ONE / 2) / ATTEMPTS_ONE;
+    } else if(it->numAttemptSamples >= MIN_ATTEMPT_SAMPLES && it->avgAttemptDuration > 0) {
+        attempts = usableSymbols / it->avgAttemptDuration;
+    } else {
+        return defaultValue;
+    }
+
+    if(attempts < 1) {
+        return 1;
+    } else if(attempts > 0xFF) {
+        return 0xFF;
+    }
+    return attempts;
+}
+
+} /* namespace dsme */
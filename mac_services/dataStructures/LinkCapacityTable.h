@@ -0,0 +1,125 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef LINKCAPACITYTABLE_H_
+#define LINKCAPACITYTABLE_H_
+
+#include "../../../dsme_settings.h"
+#include "../../helper/Integers.h"
+#include "./RBTree.h"
+
+namespace dsme {
+
+struct LinkCapacityEntry {
+    uint16_t address;
+
+    /* time a single transmission attempt occupies the slot, including the ACK (if any) and the IFS, in symbols */
+    uint16_t avgAttemptDuration;
+    uint16_t numAttemptSamples;
+
+    /* transmission attempts per slot in units of 1/ATTEMPTS_ONE, only measured in slots that were limited by time */
+    uint16_t avgAttemptsPerSlot;
+    uint16_t numSlotSamples;
+};
+
+/*
+ * Estimates how many transmission attempts fit into a GTS per neighbor.
+ * Instead of assuming frames of maximum size and the full ACK wait duration,
+ * the estimate is based on the measured slot occupancy of every attempt and on
+ * the number of attempts that were actually made in slots that ran out of time
+ * before the queue was empty. Integer arithmetic only, like the LinkQualityTable.
+ */
+class LinkCapacityTable {
+public:
+    typedef RBTree<LinkCapacityEntry, uint16_t>::iterator iterator;
+
+    static constexpr uint16_t ATTEMPTS_ONE = 1 << 4;
+
+    /* weight of a new sample is 1/2^EWMA_SHIFT */
+    static constexpr uint8_t EWMA_SHIFT = 3;
+
+    /* minimum number of samples before the estimate is used */
+    static constexpr uint16_t MIN_ATTEMPT_SAMPLES = 8;
+    static constexpr uint16_t MIN_SLOT_SAMPLES = 4;
+
+    static constexpr uint16_t MAX_ENTRIES = MAX_NEIGHBORS;
+
+    LinkCapacityTable() = default;
+    LinkCapacityTable(const LinkCapacityTable&) = delete;
+
+    iterator begin();
+
+    iterator end();
+
+    void clear();
+
+    /**
+     * Records how long a single transmission attempt occupied the slot
+     * @param address short address of the neighbor
+     * @param duration symbols from the start of the transmission until the next frame may be sent
+     */
+    void updateAttempt(uint16_t address, uint32_t duration);
+
+    /**
+     * Records the number of attempts made during a GTS that ended while frames were still queued
+     * @param address short address of the neighbor
+     * @param numAttempts number of transmission attempts in this GTS
+     */
+    void updateSaturatedSlot(uint16_t address, uint8_t numAttempts);
+
+    /**
+     * @param address short address of the neighbor
+     * @param usableSymbols symbols of a slot that are available for transmissions
+     * @param defaultValue value returned if no estimate is available
+     * @return the expected number of transmission attempts per GTS, at least 1
+     */
+    uint8_t getAttemptsPerSlot(uint16_t address, uint32_t usableSymbols, uint8_t defaultValue);
+
+private:
+    iterator findOrInsert(uint16_t address);
+
+    RBTree<LinkCapacityEntry, uint16_t> table;
+};
+
+} /* namespace dsme */
+
+#endif /* LINKCAPACITYTABLE_H_ */
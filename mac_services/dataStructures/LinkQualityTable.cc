@@ -0,0 +1,140 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "./LinkQualityTable.h"
+
+#include "../../../dsme_platform.h"
+
+namespace dsme {
+
+constexpr uint8_t LinkQualityTable::ALL_CHANNELS;
+constexpr uint16_t LinkQualityTable::PRR_ONE;
+constexpr uint16_t LinkQualityTable::ETX_ONE;
+constexpr uint16_t LinkQualityTable::ETX_INFINITE;
+
+LinkQualityTable::iterator LinkQualityTable::begin() {
+    return table.begin();
+}
+
+LinkQualityTable::iterator LinkQualityTable::end() {
+    return table.end();
+}
+
+void LinkQualityTable::clear() {
+    while(this->table.size() != 0) {
+        auto it = this->table.begin();
+        this->table.remove(it);
+    }
+}
+
+void LinkQualityTable::update(uint16_t address, uint8_t channel, bool success, uint8_t transmissionAttempts) {
+    for(uint8_t i = 1; i < transmissionAttempts; i++) {
+        addSample(address, channel, false);
+    }
+    if(transmissionAttempts > 0) {
+        addSample(address, channel, success);
+    }
+}
+
+void LinkQualityTable::addSample(uint16_t address, uint8_t channel, bool success) {
+    uint8_t channels[2] = {channel, ALL_CHANNELS};
+    for(uint8_t i = 0; i < ((channel == ALL_CHANNELS) ? 1 : 2); i++) {
+        LinkQualityPosition pos{address, channels[i]};
+        iterator it = this->table.find(pos);
+        if(it == this->table.end()) {
+            if(this->table.size() >= MAX_ENTRIES) {
+                LOG_DEBUG("LinkQualityTable full, dropping sample for 0x" << HEXOUT << address << DECOUT);
+                continue;
+            }
+
+            /* start optimistic, so new links are not penalized */
+            LinkQualityEntry entry{address, channels[i], PRR_ONE, 0};
+            this->table.insert(entry, pos);
+            it = this->table.find(pos);
+            DSME_ASSERT(it != this->table.end());
+        }
+
+        it->prr = it->prr - (it->prr >> EWMA_SHIFT) + ((success ? PRR_ONE : 0) >> EWMA_SHIFT);
+        if(it->numSamples < 0xFFFF) {
+            it->numSamples++;
+        }
+    }
+}
+
+bool LinkQualityTable::hasEstimate(uint16_t address, uint8_t channel) {
+    iterator it = this->table.find(LinkQualityPosition{address, channel});
+    return it != this->table.end() && it->numSamples >= MIN_SAMPLES;
+}
+
+uint16_t LinkQualityTable::getPRR(uint16_t address, uint8_t channel) {
+    iterator it = this->table.find(LinkQualityPosition{address, channel});
+    if(it == this->table.end() || it->numSamples < MIN_SAMPLES) {
+        return PRR_ONE;
+    }
+    return it->prr;
+}
+
+uint16_t LinkQualityTable::getETX(uint16_t address, uint8_t channel) {
+    uint16_t prr = getPRR(address, channel);
+    if(prr == 0) {
+        return ETX_INFINITE;
+    }
+
+    uint32_t etx = ((uint32_t)PRR_ONE * ETX_ONE) / prr;
+    return (etx < ETX_INFINITE) ? etx : ETX_INFINITE;
+}
+
+uint8_t LinkQualityTable::getRetryBudget(uint16_t address, uint8_t channel, uint8_t maxRetries) {
+    /* prefer the estimate of the channel, but fall back to the neighbor if the channel is new */
+    uint16_t prr = hasEstimate(address, channel) ? getPRR(address, channel) : getPRR(address, ALL_CHANNELS);
+
+    if(prr < PRR_ONE / 16) {
+        /* '-> hopeless, retries would only burn the slot */
+        return 0;
+    } else if(prr < PRR_ONE / 4 && maxRetries > 1) {
+        return 1;
+    } else {
+        return maxRetries;
+    }
+}
+
+} /* namespace dsme */
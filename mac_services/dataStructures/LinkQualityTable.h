@@ -0,0 +1,166 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef LINKQUALITYTABLE_H_
+#define LINKQUALITYTABLE_H_
+
+#include "../../../dsme_settings.h"
+#include "../../helper/Integers.h"
+#include "./RBTree.h"
+
+namespace dsme {
+
+struct LinkQualityPosition {
+    uint16_t address;
+    uint8_t channel;
+
+    bool operator>(const LinkQualityPosition& other) const {
+        if(this->address > other.address) {
+            return true;
+        }
+        if(this->address < other.address) {
+            return false;
+        }
+        return this->channel > other.channel;
+    }
+
+    bool operator<(const LinkQualityPosition& other) const {
+        if(this->address < other.address) {
+            return true;
+        }
+        if(this->address > other.address) {
+            return false;
+        }
+        return this->channel < other.channel;
+    }
+
+    bool operator==(const LinkQualityPosition& other) const {
+        return ((address == other.address) && (channel == other.channel));
+    }
+};
+
+struct LinkQualityEntry {
+    uint16_t address;
+    uint8_t channel;
+
+    /* packet reception ratio of single transmission attempts, PRR_ONE corresponds to 100% */
+    uint16_t prr;
+
+    /* number of transmission attempts the estimate is based on (saturating) */
+    uint16_t numSamples;
+};
+
+/*
+ * Estimates the delivery ratio of the outgoing links per neighbor and per channel.
+ * The estimate is an exponentially weighted moving average over all acknowledged
+ * transmission attempts. Integer arithmetic only, so it can be used on small platforms.
+ */
+class LinkQualityTable {
+public:
+    typedef RBTree<LinkQualityEntry, LinkQualityPosition>::iterator iterator;
+
+    /* channel used for the estimate over all channels of a neighbor */
+    static constexpr uint8_t ALL_CHANNELS = 0xFF;
+
+    static constexpr uint16_t PRR_ONE = 1 << 12;
+
+    /* ETX is given in 1/256 */
+    static constexpr uint16_t ETX_ONE = 1 << 8;
+    static constexpr uint16_t ETX_INFINITE = 0xFFFF;
+
+    /* weight of a new sample is 1/2^EWMA_SHIFT */
+    static constexpr uint8_t EWMA_SHIFT = 3;
+
+    /* minimum number of samples before the estimate is used */
+    static constexpr uint16_t MIN_SAMPLES = 4;
+
+    static constexpr uint16_t MAX_ENTRIES = MAX_NEIGHBORS * (MAX_CHANNELS + 1);
+
+    LinkQualityTable() = default;
+    LinkQualityTable(const LinkQualityTable&) = delete;
+
+    iterator begin();
+
+    iterator end();
+
+    void clear();
+
+    /**
+     * Records the result of a transmission to a neighbor
+     * @param address short address of the neighbor
+     * @param channel channel number the transmission took place on
+     * @param success true if the last attempt was acknowledged
+     * @param transmissionAttempts number of attempts, all but the last one failed
+     */
+    void update(uint16_t address, uint8_t channel, bool success, uint8_t transmissionAttempts);
+
+    /**
+     * @return true if enough samples are available for a meaningful estimate
+     */
+    bool hasEstimate(uint16_t address, uint8_t channel = ALL_CHANNELS);
+
+    /**
+     * @return the estimated PRR in units of 1/PRR_ONE, PRR_ONE if no estimate is available
+     */
+    uint16_t getPRR(uint16_t address, uint8_t channel = ALL_CHANNELS);
+
+    /**
+     * @return the expected number of transmission attempts in units of 1/ETX_ONE, ETX_ONE if no estimate is available
+     */
+    uint16_t getETX(uint16_t address, uint8_t channel = ALL_CHANNELS);
+
+    /**
+     * Reduces the number of retries for links that are unlikely to deliver a frame anyway.
+     * @param maxRetries the configured maximum number of retries (macMaxFrameRetries)
+     * @return the number of retries that should be spent on a frame
+     */
+    uint8_t getRetryBudget(uint16_t address, uint8_t channel, uint8_t maxRetries);
+
+private:
+    void addSample(uint16_t address, uint8_t channel, bool success);
+
+    RBTree<LinkQualityEntry, LinkQualityPosition> table;
+};
+
+} /* namespace dsme */
+
+#endif /* LINKQUALITYTABLE_H_ */
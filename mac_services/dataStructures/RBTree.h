@@ -100,6 +100,12 @@ public:
      */
     iterator find(K key);
 
+    /*
+     * Return iterator to the object with the smallest key, or end() if the tree is empty
+     * The iterator order is not sorted, so this is the only way to access the tree in key order.
+     */
+    iterator min();
+
     /*
      * Return number of elements in the RBTree
      */
@@ -196,6 +202,15 @@ typename RBTree<T, K>::iterator RBTree<T, K>::begin() {
     return RBTree<T, K>::iterator::begin(this, root);
 }
 
+template <typename T, typename K>
+typename RBTree<T, K>::iterator RBTree<T, K>::min() {
+    RBNode<T, K>* node = root;
+    while(node != nullptr && node->leftChild != nullptr) {
+        node = node->leftChild;
+    }
+    return RBTree<T, K>::iterator(this, node);
+}
+
 template <typename T, typename K>
 typename RBTree<T, K>::iterator RBTree<T, K>::end() {
     return RBTree<T, K>::iterator(this, nullptr);
@@ -49,6 +49,7 @@
 #include "../dataStructures/DSMEAllocationCounterTable.h"
 #include "../dataStructures/IEEE802154MacAddress.h"
 #include "../pib/MAC_PIB.h"
+#include "../pib/dsme_phy_constants.h"
 
 namespace dsme {
 namespace mcps_sap {
@@ -76,6 +77,23 @@ void DATA::request(request_parameters& params) {
 
     msg->setReceivedViaMCPS(true);
 
+    DSME_ASSERT(params.trafficClass < NUM_TRAFFIC_CLASSES);
+    msg->trafficClass = params.trafficClass;
+
+    /*
+     * IEEE 802.15.4e-2012 6.4.2, Table 52
+     * A critical event message expires macCritMsgDelayTol milliseconds after the first request.
+     * A deadline that is already set is kept, so a repeated request does not extend it.
+     */
+    if(params.criticalEventMessage) {
+        if(!msg->hasDeadline) {
+            msg->deadline = this->dsme.getPlatform().getSymbolCounter() + (this->dsme.getMAC_PIB().macCritMsgDelayTol * 1000) / aSymbolDuration;
+            msg->hasDeadline = true;
+        }
+    } else {
+        msg->hasDeadline = false;
+    }
+
     IEEE802154eMACHeader& header = msg->getHeader();
 
     header.setFrameType(IEEE802154eMACHeader::DATA);
@@ -152,7 +152,9 @@ public:
         bool seqNumSuppressed;
         bool sendMultipurpose;
         NOT_IMPLEMENTED_t frakPolicy;
-        NOT_IMPLEMENTED_t criticalEventMessage;
+        bool criticalEventMessage{false};
+
+        TrafficClass::Traffic_Class trafficClass{TrafficClass::BEST_EFFORT}; // not covered by the standard, selects the GTS queue
     };
 
     void request(request_parameters&);
@@ -0,0 +1,5 @@
+#!/bin/bash
+
+# Checks the backoff exponent of prioritized channel access
+cd "$(dirname "$0")"
+${CXX:-g++} -std=c++11 -Wall -o /tmp/dsme_check_priority_backoff check_priority_backoff.cc && /tmp/dsme_check_priority_backoff
@@ -0,0 +1,113 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Checks that critical data overtakes queued best-effort data in the CAP queue.
+ * Build and run with check_cap_queue.sh, returns non-zero if a check fails.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#define DSME_ASSERT(x)                                                                                                                                         \
+    if(!(x)) {                                                                                                                                                 \
+        printf("assertion failed: %s\n", #x);                                                                                                                  \
+        exit(1);                                                                                                                                               \
+    }
+
+#include "../../dsmeLayer/capLayer/CAPQueue.h"
+
+namespace dsme {
+
+constexpr uint16_t QUEUE_SIZE = 8;
+
+static bool check(bool condition, const char* description) {
+    printf("%s: %s\n", condition ? "ok" : "FAILED", description);
+    return condition;
+}
+
+static bool checkCriticalOvertakesData() {
+    CAPQueue<int, QUEUE_SIZE> queue;
+    int bulk[4] = {0, 1, 2, 3};
+    int critical = 10;
+    int deadline = 11;
+
+    for(int& frame : bulk) {
+        queue.push(frame, CAPClass::forData(TrafficClass::BEST_EFFORT, false));
+    }
+    queue.push(critical, CAPClass::forData(TrafficClass::CRITICAL, false));
+    queue.push(deadline, CAPClass::forData(TrafficClass::BEST_EFFORT, true));
+
+    bool ok = check(queue.front() == critical, "critical frame is served before the queued best-effort frames");
+    queue.pop();
+    ok &= check(queue.front() == deadline, "frame with deadline is served before the queued best-effort frames");
+    queue.pop();
+    ok &= check(queue.front() == bulk[0], "best-effort frames follow in their order");
+    return ok;
+}
+
+static bool checkSelectedFrameIsKept() {
+    CAPQueue<int, QUEUE_SIZE> queue;
+    int bulk[2] = {0, 1};
+    int critical = 10;
+
+    for(int& frame : bulk) {
+        queue.push(frame, CAPClass::forData(TrafficClass::BEST_EFFORT, false));
+    }
+
+    /* '-> the front frame is processed by the CSMA/CA when the critical frame arrives */
+    queue.front();
+    queue.push(critical, CAPClass::forData(TrafficClass::CRITICAL, false));
+
+    bool ok = check(queue.front() == bulk[0], "frame in the CSMA/CA is not preempted");
+    queue.pop();
+    ok &= check(queue.front() == critical, "critical frame overtakes the remaining best-effort frames");
+    return ok;
+}
+
+} /* namespace dsme */
+
+int main() {
+    bool overtakes = dsme::checkCriticalOvertakesData();
+    bool kept = dsme::checkSelectedFrameIsKept();
+    return (overtakes && kept) ? 0 : 1;
+}
@@ -0,0 +1,5 @@
+#!/bin/bash
+
+# Checks the class order of the CAP queue
+cd "$(dirname "$0")"
+${CXX:-g++} -std=c++11 -Wall -o /tmp/dsme_check_cap_queue check_cap_queue.cc && /tmp/dsme_check_cap_queue
@@ -7,3 +7,6 @@ echo "Applying auto-style."
 ./utils/code_quality/check_guards.py
 ./utils/code_quality/check_namespaces.py
 ./utils/code_quality/check_includes.py
+./utils/scheduling_arithmetic/check_arithmetic.sh
+./utils/cap_queue/check_cap_queue.sh
+./utils/cap_backoff/check_priority_backoff.sh
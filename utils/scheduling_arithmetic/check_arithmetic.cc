@@ -0,0 +1,145 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Compares the fixed-point variants of the TPS and PID computations against the float reference
+ * over a fixed set of inputs. Build and run with check_arithmetic.sh, returns non-zero if a bound is exceeded.
+ */
+
+#include <cmath>
+#include <cstdio>
+
+#include "../../dsmeAdaptionLayer/scheduling/SchedulingArithmetic.h"
+
+namespace dsme {
+
+typedef FixedPointArithmetic<16> Fixed;
+typedef SchedulingControl<Fixed> FixedControl;
+typedef SchedulingControl<FloatArithmetic> FloatControl;
+
+/* maximum deviation of the TPS error term from the float reference */
+constexpr float TPS_ERROR_BOUND = 0.004f;
+
+/* ETX_ONE of the LinkQualityTable */
+constexpr uint16_t ETX_ONE = 1 << 8;
+
+static uint32_t lcgState = 1;
+
+/* deterministic pseudo random number in [0, range) */
+static uint16_t nextInput(uint16_t range) {
+    lcgState = lcgState * 1103515245 + 12345;
+    return (lcgState >> 16) % range;
+}
+
+static bool checkTPS() {
+    const float alphas[] = {0.05f, 0.1f, 0.25f, 0.5f, 0.9f};
+    const uint16_t etxs[] = {ETX_ONE, ETX_ONE + 1, 300, 2 * ETX_ONE, 777, 8 * ETX_ONE};
+    const uint16_t packetsPerSlot[] = {1, 2, 3, 7};
+
+    float maxDeviation = 0;
+    for(float alpha : alphas) {
+        Fixed::value_t fixedAvg = 0;
+        float floatAvg = 0;
+
+        for(uint16_t step = 0; step < 500; step++) {
+            uint16_t messages = nextInput(step < 250 ? 60 : 8);
+            fixedAvg = FixedControl::average(fixedAvg, messages, FixedControl::alphaFromFloat(alpha));
+            floatAvg = FloatControl::average(floatAvg, messages, FloatControl::alphaFromFloat(alpha));
+
+            for(uint16_t etx : etxs) {
+                for(uint16_t packets : packetsPerSlot) {
+                    uint8_t slots = nextInput(16);
+                    float fixedError = Fixed::toFloat(FixedControl::tpsError(fixedAvg, etx, packets, ETX_ONE, slots));
+                    float floatError = FloatControl::tpsError(floatAvg, etx, packets, ETX_ONE, slots);
+                    float deviation = std::fabs(fixedError - floatError);
+                    if(deviation > maxDeviation) {
+                        maxDeviation = deviation;
+                    }
+                }
+            }
+        }
+    }
+
+    printf("TPS: maximum deviation of the error term %f (bound %f)\n", maxDeviation, TPS_ERROR_BOUND);
+    return maxDeviation <= TPS_ERROR_BOUND;
+}
+
+static bool checkPID() {
+    /* DEFAULT_PID_GAINS of PIDScheduling.h */
+    const int16_t gains[] = {0, 30, 26, 50, 30, 38};
+    const int32_t scaling = 1 << 7;
+
+    Fixed::value_t fixedGains[6];
+    float floatGains[6];
+    for(uint8_t k = 0; k < 6; k++) {
+        fixedGains[k] = Fixed::fromRatio(gains[k], scaling);
+        floatGains[k] = FloatArithmetic::fromRatio(gains[k], scaling);
+    }
+
+    uint32_t mismatches = 0;
+    for(int16_t e = -64; e <= 64; e++) {
+        for(int16_t i = -512; i <= 512; i += 7) {
+            for(int16_t d = -64; d <= 64; d += 3) {
+                uint8_t k = (e > 0) ? 0 : 3;
+                int16_t fixedOutput = FixedControl::pid(fixedGains[k], fixedGains[k + 1], fixedGains[k + 2], e, i, d);
+                int16_t floatOutput = FloatControl::pid(floatGains[k], floatGains[k + 1], floatGains[k + 2], e, i, d);
+                if(fixedOutput != floatOutput) {
+                    if(mismatches == 0) {
+                        printf("PID: e=%d i=%d d=%d fixed %d float %d\n", e, i, d, fixedOutput, floatOutput);
+                    }
+                    mismatches++;
+                }
+            }
+        }
+    }
+
+    printf("PID: %u mismatching outputs\n", mismatches);
+    return mismatches == 0;
+}
+
+} /* namespace dsme */
+
+int main() {
+    bool tps = dsme::checkTPS();
+    bool pid = dsme::checkPID();
+    return (tps && pid) ? 0 : 1;
+}
@@ -0,0 +1,5 @@
+#!/bin/bash
+
+# Compares the fixed-point scheduler arithmetic against the float reference
+cd "$(dirname "$0")"
+${CXX:-g++} -std=c++11 -Wall -o /tmp/dsme_check_arithmetic check_arithmetic.cc && /tmp/dsme_check_arithmetic